@@ -97,8 +97,9 @@ verify_hardware() {
         handle_error "Componentes faltando: ${missing[*]}"
     fi
     
+    # O launcher detecta o dispositivo via hotplug; ele pode ser conectado depois
     if ! lsusb | grep -q "16d0:0"; then
-        handle_error "Nenhum dispositivo háptico detectado!"
+        printf "\033[1;33mAVISO: Nenhum dispositivo háptico detectado. Conecte-o a qualquer momento.\033[0m\n"
     fi
 }
 
@@ -121,6 +122,13 @@ EOL
 
     sudo udevadm control --reload-rules
     sudo udevadm trigger
+
+    # Permite SCHED_FIFO e mlockall para o modo --realtime sem rodar como root
+    echo "⏱️  Aplicando limites de tempo real..."
+    sudo tee /etc/security/limits.d/99-haptic-rt.conf > /dev/null <<EOL
+@plugdev - rtprio 90
+@plugdev - memlock unlimited
+EOL
 }
 
 # Instalação de dependências
@@ -159,14 +167,13 @@ prepare_build() {
 # Função para verificar e copiar configurações
 handle_config() {
     echo "📄 Verificando arquivo de configuração..."
-    local src_config="${SRC_DIR}/${CONFIG_FILE}"
     local build_config="${BUILD_DIR}/${CONFIG_FILE}"
     
-    if [ ! -f "${src_config}" ]; then
-        handle_error "Arquivo de configuração não encontrado em: ${src_config}"
+    # O CMake gera o arquivo (configure_file) com @CHAI3D_EXAMPLES_DIR@ já
+    # substituído; copiar o modelo de src/ por cima desfaria a substituição
+    if [ ! -f "${build_config}" ]; then
+        handle_error "Arquivo de configuração não gerado pelo CMake: ${build_config}"
     fi
-    
-    cp -v "${src_config}" "${build_config}" || handle_error "Falha ao copiar arquivo de configuração"
 }
 
 # Função de compilação do projeto
@@ -180,7 +187,7 @@ build_project() {
     cmake -DCMAKE_BUILD_TYPE="${build_type}" -DDISABLE_HAPTICS=$DISABLE_HAPTICS .. || handle_error "Falha na configuração CMake"
     make -j"$(nproc)" || handle_error "Falha na compilação"
     
-    handle_config  # Garantir que o arquivo de configuração está no build
+    handle_config  # Garantir que o CMake gerou o arquivo de configuração no build
     
     cd ..
 }
@@ -197,7 +204,8 @@ run_full_mode() {
     show_header
     echo -e "\n🔥 Iniciando aplicação completa...\n"
     cd "${BUILD_DIR}"
-    taskset -c 0 "./${EXECUTABLE}"
+    # Sem taskset: cada thread servo se fixa no próprio núcleo, longe da UI
+    "./${EXECUTABLE}" --realtime
 }
 
 # Fluxo principal
@@ -0,0 +1,89 @@
+#include "alloc_tracker.h"
+
+#ifdef ENABLE_ALLOC_TRACKING
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> g_alocacoes{0};
+std::atomic<uint64_t> g_bytes{0};
+std::atomic<uint64_t> g_liberacoes{0};
+thread_local uint64_t t_alocacoes = 0;
+thread_local uint64_t t_bytes = 0;
+
+void* alocar(std::size_t tamanho) {
+    g_alocacoes.fetch_add(1, std::memory_order_relaxed);
+    t_alocacoes++;
+    t_bytes += tamanho;
+    g_bytes.fetch_add(tamanho, std::memory_order_relaxed);
+    if (tamanho == 0) tamanho = 1;
+    return std::malloc(tamanho);
+}
+
+void* alocarAlinhado(std::size_t tamanho, std::size_t alinhamento) {
+    g_alocacoes.fetch_add(1, std::memory_order_relaxed);
+    t_alocacoes++;
+    t_bytes += tamanho;
+    g_bytes.fetch_add(tamanho, std::memory_order_relaxed);
+    if (tamanho == 0) tamanho = 1;
+    tamanho = (tamanho + alinhamento - 1) & ~(alinhamento - 1); // aligned_alloc exige múltiplo do alinhamento
+    return std::aligned_alloc(alinhamento, tamanho);
+}
+
+void liberar(void* p) {
+    if (!p) return;
+    g_liberacoes.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+} // namespace
+
+void* operator new(std::size_t n) {
+    if (void* p = alocar(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) {
+    if (void* p = alocar(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return alocar(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return alocar(n); }
+void* operator new(std::size_t n, std::align_val_t a) {
+    if (void* p = alocarAlinhado(n, (std::size_t)a)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t a) {
+    if (void* p = alocarAlinhado(n, (std::size_t)a)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { liberar(p); }
+void operator delete[](void* p) noexcept { liberar(p); }
+void operator delete(void* p, std::size_t) noexcept { liberar(p); }
+void operator delete[](void* p, std::size_t) noexcept { liberar(p); }
+void operator delete(void* p, std::align_val_t) noexcept { liberar(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { liberar(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { liberar(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { liberar(p); }
+
+namespace ContadorAlocacoes {
+bool ativo() { return true; }
+uint64_t alocacoes() { return g_alocacoes.load(std::memory_order_relaxed); }
+uint64_t bytes() { return g_bytes.load(std::memory_order_relaxed); }
+uint64_t liberacoes() { return g_liberacoes.load(std::memory_order_relaxed); }
+uint64_t alocacoesThread() { return t_alocacoes; }
+uint64_t bytesThread() { return t_bytes; }
+}
+
+#else
+
+namespace ContadorAlocacoes {
+bool ativo() { return false; }
+uint64_t alocacoes() { return 0; }
+uint64_t bytes() { return 0; }
+uint64_t liberacoes() { return 0; }
+uint64_t alocacoesThread() { return 0; }
+uint64_t bytesThread() { return 0; }
+}
+
+#endif
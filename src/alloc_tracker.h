@@ -0,0 +1,17 @@
+// alloc_tracker.h
+#pragma once
+#include <cstdint>
+
+// Contagem global de alocações no heap (operator new/delete substituídos).
+// Só é compilada com ENABLE_ALLOC_TRACKING; caso contrário 'ativo()' retorna
+// false e os contadores ficam em zero.
+namespace ContadorAlocacoes {
+    bool ativo();
+    uint64_t alocacoes();  // Total de chamadas a operator new desde o início
+    uint64_t bytes();      // Total de bytes pedidos desde o início
+    uint64_t liberacoes(); // Total de chamadas a operator delete (ponteiro não nulo)
+    // Da thread atual: o que o quadro da UI aloca, sem as outras threads
+    // (servidor de métricas, log, etapas em segundo plano) no meio
+    uint64_t alocacoesThread(); // Chamadas a operator new feitas pela thread atual
+    uint64_t bytesThread();     // Bytes pedidos pela thread atual
+}
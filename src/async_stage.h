@@ -0,0 +1,56 @@
+// async_stage.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <utility>
+
+// Uma etapa da inicialização executada numa thread própria. A thread da UI
+// consulta a cada quadro, sem bloquear, e adota o resultado uma única vez —
+// o que precisa de OpenGL ou do contexto ImGui fica para esse momento.
+template <typename T>
+class EtapaAssincrona {
+public:
+    EtapaAssincrona() = default;
+    EtapaAssincrona(const EtapaAssincrona&) = delete;
+    EtapaAssincrona& operator=(const EtapaAssincrona&) = delete;
+    ~EtapaAssincrona() { if (thread.joinable()) thread.join(); }
+
+    // Pode ser reiniciada depois que o resultado anterior foi tomado (ex.:
+    // recarregar o catálogo). 'aoConcluir' roda na thread de trabalho, depois de
+    // publicar o resultado — para acordar a UI, que pode estar dormindo.
+    template <typename Tarefa>
+    void iniciar(Tarefa tarefa, std::function<void()> aoConcluir = nullptr) {
+        if (thread.joinable()) thread.join();
+        concluida.store(false, std::memory_order_relaxed);
+        inicio = std::chrono::steady_clock::now();
+        thread = std::thread([this, tarefa = std::move(tarefa), aoConcluir = std::move(aoConcluir)]() mutable {
+            resultado = tarefa();
+            duracaoMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+            concluida.store(true, std::memory_order_release);
+            if (aoConcluir) aoConcluir();
+        });
+    }
+
+    // Iniciada e ainda não adotada.
+    bool pendente() const { return thread.joinable(); }
+
+    // Move o resultado para 'destino' na primeira chamada depois que a tarefa terminou.
+    bool tomar(T& destino) {
+        if (!thread.joinable() || !concluida.load(std::memory_order_acquire)) return false;
+        thread.join();
+        destino = std::move(resultado);
+        return true;
+    }
+
+    // Tempo da tarefa na thread de trabalho; válido depois de tomar().
+    double ms() const { return duracaoMs; }
+
+private:
+    std::thread thread;
+    std::atomic<bool> concluida{false};
+    std::chrono::steady_clock::time_point inicio;
+    double duracaoMs = 0.0;
+    T resultado{};
+};
@@ -0,0 +1,272 @@
+#include "bench.h"
+#include "alloc_tracker.h"
+#include <jsoncpp/json/json.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+
+const char* MATERIAS_SINTETICAS[] = {
+    "Matemática", "Língua Portuguesa", "Ciências", "Geografia", "História", "Artes Visuais",
+    "Música", "Educação Física", "Coordenação Motora", "Geometria e Formas", "Física Básica", "Percepção Tátil",
+};
+const char* HABILIDADES_SINTETICAS[] = {
+    "Contagem", "Reconhecimento de Formas", "Coordenação Olho-Mão", "Leitura Tátil", "Memória",
+    "Sequenciamento", "Percepção Espacial", "Força e Pressão", "Atenção", "Classificação",
+    "Noção de Peso", "Ritmo", "Manipulação 3D", "Resolução de Problemas", "Cores", "Texturas",
+};
+const char* VERBOS[] = { "Explorar", "Reconhecer", "Manipular", "Comparar", "Organizar", "Sentir", "Identificar" };
+const char* OBJETOS[] = {
+    "formas geométricas em 3D", "texturas com diferentes rigidezes", "letras em relevo", "objetos com massas diferentes",
+    "sequências de cores e sons", "caminhos em um labirinto", "números e quantidades", "superfícies com atrito variável",
+};
+const char* COMPLEMENTOS[] = {
+    "com feedback tátil progressivo.", "usando o dispositivo háptico como guia.", "em atividades cooperativas.",
+    "com níveis de dificuldade ajustáveis.", "acompanhando a orientação do professor.", "em um ambiente virtual simples.",
+};
+const char* TERMOS_PESQUISA[] = { "mate", "form", "text", "coord", "son", "3d" };
+
+template <size_t N>
+const char* sortear(const char* (&lista)[N], std::mt19937& rng) {
+    return lista[std::uniform_int_distribution<size_t>(0, N - 1)(rng)];
+}
+
+double msDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+double percentil(std::vector<double> valores, double p) {
+    if (valores.empty()) return 0.0;
+    size_t k = (size_t)((p / 100.0) * (valores.size() - 1) + 0.5);
+    std::nth_element(valores.begin(), valores.begin() + k, valores.end());
+    return valores[k];
+}
+
+bool lerNumero(const char* texto, long long minimo, long long& saida) {
+    char* fim = nullptr;
+    long long v = std::strtoll(texto, &fim, 10);
+    if (!fim || *fim != '\0' || v < minimo) return false;
+    saida = v;
+    return true;
+}
+
+Json::Value jsonContadores(const AmostraContadores& c, size_t quadros) {
+    Json::Value v;
+    v["cycles"] = (Json::UInt64)c.ciclos;
+    v["instructions"] = (Json::UInt64)c.instrucoes;
+    v["ipc"] = c.ipc();
+    if (ContadoresCpu::disponiveis() & ContadoresCpu::FALTAS_CACHE) {
+        v["cache_misses"] = (Json::UInt64)c.faltasCache;
+        v["cache_mpki"] = c.faltasCacheMpki();
+    }
+    if (ContadoresCpu::disponiveis() & ContadoresCpu::ERROS_DESVIO) {
+        v["branch_misses"] = (Json::UInt64)c.errosDesvio;
+        v["branch_mpki"] = c.errosDesvioMpki();
+    }
+    if (quadros > 0) v["cycles_per_frame"] = (double)c.ciclos / quadros;
+    return v;
+}
+
+} // namespace
+
+bool lerOpcoesBench(int argc, char** argv, OpcoesBench& opcoes) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto proximo = [&](const char*& valor) {
+            if (i + 1 >= argc) { std::cerr << "Argumento sem valor: " << arg << std::endl; return false; }
+            valor = argv[++i];
+            return true;
+        };
+        const char* valor = nullptr;
+        long long n = 0;
+        if (arg == "--bench") {
+            opcoes.ativo = true;
+        } else if (arg == "--bench-games") {
+            if (!proximo(valor) || !lerNumero(valor, 1, n)) { std::cerr << "Valor inválido para --bench-games" << std::endl; return false; }
+            opcoes.jogos = (size_t)n;
+        } else if (arg == "--bench-frames") {
+            if (!proximo(valor) || !lerNumero(valor, 1, n)) { std::cerr << "Valor inválido para --bench-frames" << std::endl; return false; }
+            opcoes.quadros = (int)n;
+        } else if (arg == "--bench-warmup") {
+            if (!proximo(valor) || !lerNumero(valor, 0, n)) { std::cerr << "Valor inválido para --bench-warmup" << std::endl; return false; }
+            opcoes.aquecimento = (int)n;
+        } else if (arg == "--bench-seed") {
+            if (!proximo(valor) || !lerNumero(valor, 0, n)) { std::cerr << "Valor inválido para --bench-seed" << std::endl; return false; }
+            opcoes.semente = (uint32_t)n;
+        } else if (arg == "--bench-out") {
+            if (!proximo(valor)) return false;
+            opcoes.saida = valor;
+        }
+    }
+    return true;
+}
+
+bool carregarCatalogoBench(const OpcoesBench& opcoes, std::vector<GameInfo>& jogos, ResultadoBench& resultado) {
+    auto inicio = std::chrono::steady_clock::now();
+    std::mt19937 rng(opcoes.semente);
+    Json::Value raiz;
+    Json::Value& lista = raiz["games"];
+    for (size_t i = 0; i < opcoes.jogos; ++i) {
+        char nome[32];
+        snprintf(nome, sizeof(nome), "bench-%05zu", i);
+        Json::Value jogo;
+        jogo["executable"] = nome;
+        jogo["subject"] = sortear(MATERIAS_SINTETICAS, rng);
+        int nHabilidades = std::uniform_int_distribution<int>(1, 4)(rng);
+        for (int h = 0; h < nHabilidades; ++h) jogo["skills"].append(sortear(HABILIDADES_SINTETICAS, rng));
+        std::string descricao = std::string(sortear(VERBOS, rng)) + " " + sortear(OBJETOS, rng) + " " + sortear(COMPLEMENTOS, rng);
+        if (std::uniform_int_distribution<int>(0, 2)(rng) == 0) // Algumas descrições longas, como no catálogo real
+            descricao += " " + std::string(sortear(VERBOS, rng)) + " também " + sortear(OBJETOS, rng) + " " + sortear(COMPLEMENTOS, rng);
+        jogo["description"] = descricao;
+        lista.append(jogo);
+    }
+    {
+        std::ofstream arquivo(opcoes.catalogo);
+        if (!arquivo.is_open()) { std::cerr << "Erro ao criar catálogo sintético: " << opcoes.catalogo << std::endl; return false; }
+        Json::StreamWriterBuilder writer;
+        arquivo << Json::writeString(writer, raiz);
+    }
+    resultado.geracaoCatalogoMs = msDesde(inicio);
+
+    // Mesmo caminho da inicialização normal, sem a varredura de diretório
+    inicio = std::chrono::steady_clock::now();
+    auto configs = loadGameConfigs(opcoes.catalogo);
+    jogos.clear();
+    jogos.reserve(configs.size());
+    for (auto& par : configs) jogos.push_back(GameInfo{ std::filesystem::path("/bench") / par.first, par.second });
+    std::sort(jogos.begin(), jogos.end(), [](const GameInfo& a, const GameInfo& b) { return a.cfg.executable < b.cfg.executable; });
+    resultado.carregamentoCatalogoMs = msDesde(inicio);
+    return !jogos.empty();
+}
+
+RoteiroBench::RoteiroBench(const OpcoesBench& opcoes, const std::set<std::string>& materias,
+                           const std::set<std::string>& habilidades, ResultadoBench& resultado)
+    : opcoes(opcoes), materias(materias.begin(), materias.end()),
+      habilidades(habilidades.begin(), habilidades.end()), resultado(resultado) {
+    resultado.quadroMs.reserve(opcoes.quadros);
+    resultado.alocacoesQuadro.reserve(opcoes.quadros);
+    resultado.bytesQuadro.reserve(opcoes.quadros);
+    resultado.quadroEstavel.reserve(opcoes.quadros);
+}
+
+void RoteiroBench::registrarQuadroAnterior() {
+    if (!medindo) return;
+    resultado.quadroMs.push_back(msDesde(inicioQuadro));
+    resultado.alocacoesQuadro.push_back(ContadorAlocacoes::alocacoesThread() - alocacoesInicio);
+    resultado.bytesQuadro.push_back(ContadorAlocacoes::bytesThread() - bytesInicio);
+    resultado.quadroEstavel.push_back(quadroAnteriorEstavel);
+}
+
+bool RoteiroBench::aplicar(uint64_t quadro, EstadoFiltros& filtros) {
+    registrarQuadroAnterior();
+    if (quadro >= (uint64_t)(opcoes.aquecimento + opcoes.quadros)) return false;
+
+    // Ciclo de 120 quadros: ocioso, digitação, ocioso, matéria, habilidade.
+    const uint64_t ciclo = quadro / 120;
+    const uint64_t t = quadro % 120;
+    bool mudou = true;
+    if (t >= 30 && t < 50 && (t - 30) % 4 == 0) {
+        const char* termo = TERMOS_PESQUISA[ciclo % (sizeof(TERMOS_PESQUISA) / sizeof(TERMOS_PESQUISA[0]))];
+        size_t n = std::min<size_t>((t - 30) / 4 + 1, std::strlen(termo));
+        std::memcpy(filtros.texto, termo, n);
+        filtros.texto[n] = '\0';
+    } else if (t == 70) {
+        filtros.texto[0] = '\0';
+        if (!materias.empty()) filtros.materia = materias[ciclo % materias.size()];
+    } else if (t == 90) {
+        filtros.materia = "Todas";
+        if (!habilidades.empty()) filtros.habilidade = habilidades[ciclo % habilidades.size()];
+    } else if (t == 110) {
+        filtros.habilidade = "Todas";
+    } else {
+        mudou = false;
+    }
+    quadroAnteriorEstavel = !mudou;
+
+    medindo = quadro >= (uint64_t)opcoes.aquecimento;
+    alocacoesInicio = ContadorAlocacoes::alocacoesThread();
+    bytesInicio = ContadorAlocacoes::bytesThread();
+    inicioQuadro = std::chrono::steady_clock::now();
+    return true;
+}
+
+uint64_t alocacoesEmQuadrosEstaveis(const ResultadoBench& resultado) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < resultado.alocacoesQuadro.size(); ++i)
+        if (resultado.quadroEstavel[i]) total += resultado.alocacoesQuadro[i];
+    return total;
+}
+
+bool escreverRelatorioBench(const OpcoesBench& opcoes, const ResultadoBench& resultado, size_t jogos) {
+    Json::Value raiz;
+    raiz["games"] = (Json::UInt64)jogos;
+    raiz["frames"] = (Json::UInt64)resultado.quadroMs.size();
+    raiz["warmup_frames"] = opcoes.aquecimento;
+    raiz["seed"] = opcoes.semente;
+    raiz["catalog"]["generate_ms"] = resultado.geracaoCatalogoMs;
+    raiz["catalog"]["load_ms"] = resultado.carregamentoCatalogoMs;
+    raiz["interface_ms"] = resultado.interfaceMs;
+
+    const std::vector<double>& q = resultado.quadroMs;
+    double soma = 0.0;
+    for (double v : q) soma += v;
+    Json::Value& cpu = raiz["frame_cpu_ms"];
+    cpu["mean"] = q.empty() ? 0.0 : soma / q.size();
+    cpu["p50"] = percentil(q, 50.0);
+    cpu["p90"] = percentil(q, 90.0);
+    cpu["p99"] = percentil(q, 99.0);
+    cpu["max"] = q.empty() ? 0.0 : *std::max_element(q.begin(), q.end());
+
+    Json::Value& aloc = raiz["allocations"];
+    aloc["tracking"] = ContadorAlocacoes::ativo();
+    if (ContadorAlocacoes::ativo()) {
+        uint64_t total = 0, maximo = 0, bytes = 0, estaveis = 0, emEstaveis = 0;
+        for (size_t i = 0; i < resultado.alocacoesQuadro.size(); ++i) {
+            total += resultado.alocacoesQuadro[i];
+            bytes += resultado.bytesQuadro[i];
+            maximo = std::max(maximo, resultado.alocacoesQuadro[i]);
+            if (resultado.quadroEstavel[i]) { estaveis++; emEstaveis += resultado.alocacoesQuadro[i]; }
+        }
+        size_t n = resultado.alocacoesQuadro.size();
+        aloc["per_frame_mean"] = n ? (double)total / n : 0.0;
+        aloc["per_frame_max"] = (Json::UInt64)maximo;
+        aloc["bytes_per_frame_mean"] = n ? (double)bytes / n : 0.0;
+        aloc["steady_frames"] = (Json::UInt64)estaveis;
+        aloc["steady_frame_allocations"] = (Json::UInt64)emEstaveis;
+        aloc["steady_state_allocation_free"] = emEstaveis == 0;
+    }
+
+    Json::Value& hw = raiz["hw_counters"];
+    hw["available"] = resultado.contadoresAtivos;
+    if (!resultado.contadoresAtivos) {
+        hw["reason"] = resultado.motivoContadores;
+    } else {
+        hw["frame"] = jsonContadores(resultado.contadoresQuadro, q.size());
+        for (const auto& fase : resultado.contadoresFases) hw["phases"][fase.first] = jsonContadores(fase.second, q.size());
+        for (const auto& etapa : resultado.etapasContadores) {
+            Json::Value v = jsonContadores(etapa.contadores, 0);
+            v["ms"] = etapa.ms;
+            v["stage"] = etapa.nome;
+            hw["startup"].append(v);
+        }
+    }
+
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) == 0) raiz["peak_rss_kb"] = (Json::Int64)uso.ru_maxrss;
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "  ";
+    std::string texto = Json::writeString(writer, raiz);
+    if (opcoes.saida == "-") {
+        std::cout << texto << std::endl;
+        return true;
+    }
+    std::ofstream arquivo(opcoes.saida);
+    if (!arquivo.is_open()) { std::cerr << "Erro ao escrever relatório do benchmark: " << opcoes.saida << std::endl; return false; }
+    arquivo << texto << std::endl;
+    return true;
+}
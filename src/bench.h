@@ -0,0 +1,79 @@
+// bench.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include "config_parser.h"
+#include "game_filter.h"
+#include "perf_counters.h"
+
+// Opções do modo benchmark (--bench). Ver lerOpcoesBench para os argumentos aceitos.
+struct OpcoesBench {
+    bool ativo = false;
+    size_t jogos = 200;            // --bench-games N
+    int quadros = 1200;            // --bench-frames N
+    int aquecimento = 60;          // --bench-warmup N (quadros descartados das estatísticas)
+    uint32_t semente = 12345;      // --bench-seed N
+    std::string saida = "bench_result.json"; // --bench-out ARQUIVO ("-" = stdout)
+    std::string catalogo = "bench_games_config.json"; // Catálogo sintético gerado
+};
+
+// Retorna false se algum argumento for inválido.
+bool lerOpcoesBench(int argc, char** argv, OpcoesBench& opcoes);
+
+// Métricas coletadas durante o benchmark.
+struct ResultadoBench {
+    double geracaoCatalogoMs = 0.0;
+    double carregamentoCatalogoMs = 0.0;  // loadGameConfigs + montagem de GameInfo
+    double interfaceMs = 0.0;             // criarInterface (fontes + textura)
+    std::vector<double> quadroMs;         // CPU por quadro (após aquecimento)
+    std::vector<uint64_t> alocacoesQuadro;
+    std::vector<uint64_t> bytesQuadro;
+    std::vector<bool> quadroEstavel;      // true se nenhum critério mudou no quadro
+
+    // Contadores de hardware (--perf-counters), somados nos quadros medidos
+    bool contadoresAtivos = false;
+    std::string motivoContadores;
+    AmostraContadores contadoresQuadro;
+    std::vector<std::pair<std::string, AmostraContadores>> contadoresFases;
+    std::vector<ContadoresCpu::Etapa> etapasContadores;
+};
+
+// Gera um catálogo sintético com N jogos em 'opcoes.catalogo' e o carrega
+// pelo mesmo caminho de produção (loadGameConfigs).
+bool carregarCatalogoBench(const OpcoesBench& opcoes, std::vector<GameInfo>& jogos, ResultadoBench& resultado);
+
+// Roteiro determinístico de interações (pesquisa, matéria, habilidade) aplicado
+// a cada quadro de executarLoop. Também mede CPU e alocações por quadro
+// (só as da thread da UI, que roda o quadro).
+class RoteiroBench {
+public:
+    RoteiroBench(const OpcoesBench& opcoes, const std::set<std::string>& materias,
+                 const std::set<std::string>& habilidades, ResultadoBench& resultado);
+
+    // Chamado no início de cada quadro; retorna false para encerrar o loop.
+    bool aplicar(uint64_t quadro, EstadoFiltros& filtros);
+
+private:
+    void registrarQuadroAnterior();
+
+    const OpcoesBench& opcoes;
+    std::vector<std::string> materias;
+    std::vector<std::string> habilidades;
+    ResultadoBench& resultado;
+
+    std::chrono::steady_clock::time_point inicioQuadro;
+    uint64_t alocacoesInicio = 0;
+    uint64_t bytesInicio = 0;
+    bool quadroAnteriorEstavel = true;
+    bool medindo = false;
+};
+
+// Alocações somadas nos quadros estáveis (nenhum critério mudou). Devem ser
+// zero: o benchmark falha se não forem, quando compilado com ENABLE_ALLOC_TRACKING.
+uint64_t alocacoesEmQuadrosEstaveis(const ResultadoBench& resultado);
+
+// Escreve o relatório JSON em opcoes.saida ("-" = stdout).
+bool escreverRelatorioBench(const OpcoesBench& opcoes, const ResultadoBench& resultado, size_t jogos);
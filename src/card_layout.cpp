@@ -0,0 +1,29 @@
+#include "card_layout.h"
+
+const LayoutGrade& GradeCards::atualizar(float larguraDisponivel, const ImVec2& espacamento,
+                                         uint64_t geracaoFiltro, size_t quantidade) {
+    if (larguraDisponivel == larguraAtual && geracaoFiltro == geracaoAtual && quantidade == quantidadeAtual &&
+        espacamento.x == espacamentoAtual.x && espacamento.y == espacamentoAtual.y) {
+        return atual;
+    }
+    larguraAtual = larguraDisponivel;
+    espacamentoAtual = espacamento;
+    geracaoAtual = geracaoFiltro;
+    quantidadeAtual = quantidade;
+
+    int colunas = (int)((larguraDisponivel + espacamento.x) / (CARD_LARGURA + espacamento.x));
+    if (colunas < 1) colunas = 1;
+
+    atual.colunas = colunas;
+    atual.linhas = (int)((quantidade + colunas - 1) / colunas);
+    atual.posicoes.resize(quantidade);
+    for (size_t i = 0; i < quantidade; ++i) {
+        int coluna = (int)(i % colunas);
+        int linha = (int)(i / colunas);
+        atual.posicoes[i] = ImVec2(coluna * (CARD_LARGURA + espacamento.x), linha * (CARD_ALTURA + espacamento.y));
+    }
+    int colunasUsadas = quantidade < (size_t)colunas ? (int)quantidade : colunas;
+    atual.tamanhoTotal = ImVec2(colunasUsadas > 0 ? colunasUsadas * CARD_LARGURA + (colunasUsadas - 1) * espacamento.x : 0.0f,
+                                atual.linhas > 0 ? atual.linhas * CARD_ALTURA + (atual.linhas - 1) * espacamento.y : 0.0f);
+    return atual;
+}
@@ -0,0 +1,34 @@
+// card_layout.h
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "imgui.h"
+
+// Dimensões fixas do card de jogo. Usadas tanto pelo layout da grade quanto
+// por mostrarCardJogo, para que os dois nunca fiquem dessincronizados.
+constexpr float CARD_LARGURA = 290.0f;
+constexpr float CARD_ALTURA = 260.0f; // Ajuste este valor se o conteúdo do card crescer
+
+// Posições dos cards visíveis, relativas ao início da área de cards.
+struct LayoutGrade {
+    int colunas = 0;
+    int linhas = 0;
+    std::vector<ImVec2> posicoes; // Uma por jogo filtrado, na mesma ordem
+    ImVec2 tamanhoTotal;
+};
+
+// Calcula a grade uma vez por (largura do painel, conjunto filtrado) e a
+// reaproveita nos quadros seguintes.
+class GradeCards {
+public:
+    const LayoutGrade& atualizar(float larguraDisponivel, const ImVec2& espacamento,
+                                 uint64_t geracaoFiltro, size_t quantidade);
+    const LayoutGrade& layout() const { return atual; }
+
+private:
+    LayoutGrade atual;
+    float larguraAtual = -1.0f;
+    ImVec2 espacamentoAtual;
+    uint64_t geracaoAtual = ~0ull;
+    size_t quantidadeAtual = 0;
+};
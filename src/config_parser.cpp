@@ -1,21 +1,29 @@
 #include "config_parser.h"
+#include "logger.h"
+#include "trace.h"
 #include <jsoncpp/json/json.h>
 #include <fstream>
-#include <iostream>
 
-std::unordered_map<std::string, GameConfig> loadGameConfigs(const std::string& configPath) {
+namespace {
+Registro::Modulo g_log{"config"};
+}
+
+std::unordered_map<std::string, GameConfig> loadGameConfigs(const std::string& configPath,
+                                                            std::vector<std::filesystem::path>* searchPaths) {
+    EscopoRastreio rastreio("loadGameConfigs", "inicializacao", configPath.c_str());
     std::unordered_map<std::string, GameConfig> configs;
 
     std::ifstream file(configPath);
     if (!file.is_open()) {
-        std::cerr << "Erro ao abrir arquivo de configuração: " << configPath << std::endl;
+        Registro::erro(g_log, "Erro ao abrir arquivo de configuração: {}", configPath);
         return configs;
     }
 
     Json::Value root;
     Json::CharReaderBuilder builder;
-    if (!Json::parseFromStream(builder, file, &root, nullptr)) {
-        std::cerr << "Erro ao parsear JSON" << std::endl;
+    std::string erros;
+    if (!Json::parseFromStream(builder, file, &root, &erros)) {
+        Registro::erro(g_log, "Erro ao parsear JSON {}: {}", configPath, erros);
         return configs;
     }
 
@@ -24,6 +32,7 @@ std::unordered_map<std::string, GameConfig> loadGameConfigs(const std::string& c
         config.executable = game["executable"].asString();
         config.subject = game["subject"].asString();
         config.description = game["description"].asString();
+        config.requiresHaptics = game.get("requires_haptics", true).asBool();
 
         for (const auto& skill : game["skills"])
             config.skills.push_back(skill.asString());
@@ -31,5 +40,13 @@ std::unordered_map<std::string, GameConfig> loadGameConfigs(const std::string& c
         configs[config.executable] = config;
     }
 
+    if (searchPaths) {
+        const std::filesystem::path base = std::filesystem::path(configPath).parent_path();
+        for (const auto& caminho : root["search_paths"]) {
+            std::filesystem::path raiz = caminho.asString();
+            searchPaths->push_back(raiz.is_relative() ? base / raiz : raiz);
+        }
+    }
+
     return configs;
 }
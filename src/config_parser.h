@@ -9,6 +9,7 @@ struct GameConfig {
     std::string subject;
     std::vector<std::string> skills;
     std::string description;
+    bool requiresHaptics = true; // "requires_haptics": sem dispositivo pronto o jogo não pode ser iniciado
 };
 
 struct GameInfo {
@@ -16,4 +17,7 @@ struct GameInfo {
     GameConfig cfg;
 };
 
-std::unordered_map<std::string, GameConfig> loadGameConfigs(const std::string& configPath);
+// searchPaths (opcional) recebe "search_paths": diretórios onde procurar os
+// executáveis, em ordem de prioridade; relativos ao diretório do arquivo.
+std::unordered_map<std::string, GameConfig> loadGameConfigs(const std::string& configPath,
+                                                            std::vector<std::filesystem::path>* searchPaths = nullptr);
@@ -0,0 +1,65 @@
+#include "device_init.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include "servo_loop.h"
+#include <exception>
+#include <pthread.h>
+#include <thread>
+
+namespace {
+Registro::Modulo g_log{"haptico"};
+}
+
+void InicializacaoDispositivo::iniciar(const std::string& nome, Tarefa tarefa, std::chrono::milliseconds prazo) {
+    if (emAndamento()) return;
+    auto tentativa = std::make_shared<Tentativa>();
+    tentativa->nome = nome;
+    tentativa->inicioNs = relogioMonotonicoNs();
+    tentativa->prazoNs = tentativa->inicioNs + (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(prazo).count();
+    std::atomic_store(&atual, tentativa);
+    std::thread(&InicializacaoDispositivo::executar, tentativa, std::move(tarefa)).detach();
+}
+
+void InicializacaoDispositivo::executar(std::shared_ptr<Tentativa> t, Tarefa tarefa) {
+    pthread_setname_np(pthread_self(), "haptic-init");
+    ParadaEmergencia::prepararThread(); // O driver pode falhar nesta thread
+    bool ok = false;
+    try {
+        ok = tarefa();
+    } catch (const std::exception& e) {
+        Registro::erro(g_log, "Inicialização de {} lançou exceção: {}", t->nome, e.what());
+    }
+    const double segundos = (relogioMonotonicoNs() - t->inicioNs) / 1e9;
+    const bool atrasada = relogioMonotonicoNs() > t->prazoNs;
+    {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        t->estado.store(ok ? Estado::Pronto : Estado::Falha);
+        t->terminou.store(true);
+    }
+    t->cv.notify_all();
+    if (ok) Registro::info(g_log, "Dispositivo háptico ({}) pronto em {} s{}.", t->nome, segundos, atrasada ? " (após o prazo)" : "");
+    else Registro::aviso(g_log, "Falha ao inicializar {} ({} s).", t->nome, segundos);
+}
+
+bool InicializacaoDispositivo::aguardar() const {
+    auto t = std::atomic_load(&atual);
+    if (!t) return false;
+    std::unique_lock<std::mutex> lock(t->mutex);
+    const uint64_t agora = relogioMonotonicoNs();
+    const auto restante = std::chrono::nanoseconds(t->prazoNs > agora ? t->prazoNs - agora : 0);
+    t->cv.wait_for(lock, restante, [&] { return t->terminou.load(); });
+    return t->estado.load() == Estado::Pronto;
+}
+
+InicializacaoDispositivo::Estado InicializacaoDispositivo::estado() const {
+    auto t = std::atomic_load(&atual);
+    if (!t) return Estado::Inativo;
+    Estado e = t->estado.load(std::memory_order_relaxed);
+    if (e == Estado::Conectando && relogioMonotonicoNs() > t->prazoNs) return Estado::TempoEsgotado;
+    return e;
+}
+
+bool InicializacaoDispositivo::emAndamento() const {
+    auto t = std::atomic_load(&atual);
+    return t && !t->terminou.load();
+}
@@ -0,0 +1,48 @@
+// device_init.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Inicialização do dispositivo háptico em segundo plano, com prazo.
+//
+// A tarefa (ex.: Haptics::initDevice) roda numa thread destacada e iniciar()
+// retorna na hora, então a janela aparece mesmo com um dispositivo USB que
+// trava na abertura. Passado o prazo o estado vira TempoEsgotado; se a tarefa
+// ainda terminar depois disso, o resultado tardio é aceito.
+// Uma thread travada não pode ser cancelada: ela só é abandonada, e
+// emAndamento() avisa quem encerra o programa para não fechar o dispositivo
+// por baixo dela.
+class InicializacaoDispositivo {
+public:
+    enum class Estado { Inativo, Conectando, Pronto, Falha, TempoEsgotado };
+    using Tarefa = std::function<bool()>;
+
+    // Não bloqueia. Ignorado se outra tentativa ainda estiver em andamento.
+    void iniciar(const std::string& nome, Tarefa tarefa, std::chrono::milliseconds prazo);
+
+    // Bloqueia até a tarefa terminar ou o prazo vencer; para threads de trabalho, nunca a UI.
+    bool aguardar() const;
+
+    Estado estado() const;        // Sem locks; pode ser chamada a cada quadro
+    bool emAndamento() const;     // A thread da tarefa ainda não retornou
+
+private:
+    struct Tentativa {
+        std::string nome;
+        uint64_t inicioNs = 0;
+        uint64_t prazoNs = 0;
+        std::atomic<Estado> estado{Estado::Conectando};
+        std::atomic<bool> terminou{false};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    static void executar(std::shared_ptr<Tentativa> tentativa, Tarefa tarefa);
+
+    std::shared_ptr<Tentativa> atual; // Acessado com std::atomic_load/atomic_store
+};
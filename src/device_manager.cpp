@@ -0,0 +1,147 @@
+#include "device_manager.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include <chrono>
+#include <cstdio>
+#include <libusb.h>
+#include <pthread.h>
+
+namespace {
+
+Registro::Modulo g_log{"usb"};
+
+// Tentativas de abrir o dispositivo após a chegada: o udev pode ainda estar
+// aplicando as permissões quando o evento de hotplug é entregue.
+constexpr int TENTATIVAS_ABERTURA = 3;
+constexpr auto INTERVALO_TENTATIVAS = std::chrono::milliseconds(300);
+
+} // namespace
+
+struct PonteLibusb {
+    static int LIBUSB_CALL aoHotplug(libusb_context*, libusb_device*, libusb_hotplug_event evento, void* dados) {
+        auto* gerenciador = static_cast<GerenciadorDispositivos*>(dados);
+        gerenciador->enfileirar(evento == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+        return 0; // Mantém o callback registrado
+    }
+};
+
+bool GerenciadorDispositivos::iniciar(uint16_t vendorId, AoConectar aoConectar, AoDesconectar aoDesconectar) {
+    if (rodando.load()) return true;
+    if (libusb_init(&contexto) != 0) {
+        Registro::erro(g_log, "libusb: falha ao inicializar.");
+        contexto = nullptr;
+        return false;
+    }
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        Registro::aviso(g_log, "libusb: hotplug não suportado nesta plataforma.");
+        libusb_exit(contexto);
+        contexto = nullptr;
+        return false;
+    }
+
+    conectar = std::move(aoConectar);
+    desconectar = std::move(aoDesconectar);
+    presentes.store(0);
+    estado.store(PresencaDispositivo::Ausente);
+    rodando.store(true);
+    threadTrabalho = std::thread(&GerenciadorDispositivos::executarTrabalho, this);
+
+    int r = libusb_hotplug_register_callback(contexto,
+        (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+        LIBUSB_HOTPLUG_ENUMERATE, vendorId, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+        &PonteLibusb::aoHotplug, this, &handleHotplug);
+    if (r != LIBUSB_SUCCESS) {
+        Registro::erro(g_log, "libusb: falha ao registrar hotplug ({}).", libusb_error_name(r));
+        parar();
+        return false;
+    }
+    threadEventos = std::thread(&GerenciadorDispositivos::executarEventos, this);
+    char fabricante[8];
+    std::snprintf(fabricante, sizeof(fabricante), "%04x", vendorId);
+    Registro::info(g_log, "Monitorando dispositivos USB {} via hotplug.", fabricante);
+    return true;
+}
+
+void GerenciadorDispositivos::parar() {
+    if (!contexto) return;
+    {
+        // Sob o mutex da fila: a thread de trabalho não pode testar 'rodando'
+        // entre o predicado e o bloqueio e perder a notificação abaixo
+        std::lock_guard<std::mutex> lock(mutexFila);
+        rodando.store(false);
+    }
+    cvFila.notify_all();
+    // Remover o callback acorda libusb_handle_events; a interrupção cobre versões em que isso não ocorre
+    if (handleHotplug) libusb_hotplug_deregister_callback(contexto, handleHotplug);
+    handleHotplug = 0;
+#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+    libusb_interrupt_event_handler(contexto);
+#endif
+    if (threadEventos.joinable()) threadEventos.join();
+    if (threadTrabalho.joinable()) threadTrabalho.join();
+
+    libusb_exit(contexto);
+    contexto = nullptr;
+}
+
+void GerenciadorDispositivos::enfileirar(bool chegada) {
+    {
+        std::lock_guard<std::mutex> lock(mutexFila);
+        fila.push_back(chegada);
+    }
+    cvFila.notify_one();
+}
+
+void GerenciadorDispositivos::executarEventos() {
+    pthread_setname_np(pthread_self(), "usb-hotplug");
+    ParadaEmergencia::prepararThread();
+    while (rodando.load()) {
+        // Bloqueia até haver evento; nada de polling
+        libusb_handle_events_completed(contexto, nullptr);
+    }
+}
+
+bool GerenciadorDispositivos::tentarConectar() {
+    for (int tentativa = 0; tentativa < TENTATIVAS_ABERTURA; ++tentativa) {
+        if (conectar && conectar()) return true;
+        // Espera antes de tentar de novo, a menos que chegue outro evento ou o gerenciador pare
+        std::unique_lock<std::mutex> lock(mutexFila);
+        if (cvFila.wait_for(lock, INTERVALO_TENTATIVAS, [this] { return !fila.empty() || !rodando.load(); })) return false;
+    }
+    return false;
+}
+
+void GerenciadorDispositivos::executarTrabalho() {
+    pthread_setname_np(pthread_self(), "usb-devices");
+    ParadaEmergencia::prepararThread();
+    while (true) {
+        bool chegada;
+        {
+            std::unique_lock<std::mutex> lock(mutexFila);
+            cvFila.wait(lock, [this] { return !fila.empty() || !rodando.load(); });
+            if (fila.empty()) break; // Parando, sem eventos pendentes
+            chegada = fila.front();
+            fila.pop_front();
+        }
+
+        int n = presentes.load();
+        if (chegada) {
+            presentes.store(++n);
+            Registro::info(g_log, "Dispositivo háptico conectado ({} presente(s)).", n);
+        } else {
+            if (n > 0) presentes.store(--n);
+            Registro::info(g_log, "Dispositivo háptico removido ({} presente(s)).", n);
+        }
+        if (n == 0) {
+            if (desconectar) desconectar();
+            estado.store(PresencaDispositivo::Ausente);
+            continue;
+        }
+        // Com vários dispositivos, toda chegada ou remoção pede nova abertura do conjunto
+        estado.store(PresencaDispositivo::Conectando);
+        bool ok = tentarConectar();
+        // Outro evento pode ter chegado durante as tentativas; ele será tratado a seguir
+        estado.store(ok ? PresencaDispositivo::Conectado : PresencaDispositivo::Falha);
+        if (!ok) Registro::aviso(g_log, "Dispositivo háptico detectado, mas não foi possível abri-lo.");
+    }
+}
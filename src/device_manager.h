@@ -0,0 +1,63 @@
+// device_manager.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct libusb_context;
+
+enum class PresencaDispositivo { Desconhecida, Ausente, Conectando, Conectado, Falha };
+
+// Acompanha a conexão/remoção de dispositivos hápticos via hotplug do libusb.
+//
+// Uma thread trata os eventos do libusb (bloqueada até algo acontecer, sem
+// polling) e apenas enfileira chegadas/remoções; outra thread de trabalho abre
+// e fecha o dispositivo, já que o libusb proíbe operações síncronas dentro do
+// callback. A UI só lê presenca(), um atômico.
+class GerenciadorDispositivos {
+public:
+    static constexpr uint16_t VENDOR_FORCE_DIMENSION = 0x16d0;
+
+    // Chamados na thread de trabalho: AoConectar a cada chegada ou remoção que deixa
+    // algum dispositivo presente (o conjunto aberto muda); AoDesconectar quando o último sai.
+    using AoConectar = std::function<bool()>;
+    using AoDesconectar = std::function<void()>;
+
+    ~GerenciadorDispositivos() { parar(); }
+
+    // Retorna false se o libusb não iniciar ou não suportar hotplug nesta plataforma.
+    // Dispositivos já conectados geram um evento de chegada logo no início.
+    bool iniciar(uint16_t vendorId, AoConectar aoConectar, AoDesconectar aoDesconectar);
+    void parar();
+
+    bool ativo() const { return rodando.load(std::memory_order_relaxed); }
+    PresencaDispositivo presenca() const { return estado.load(std::memory_order_relaxed); }
+    int dispositivosPresentes() const { return presentes.load(std::memory_order_relaxed); }
+
+private:
+    friend struct PonteLibusb;
+
+    void enfileirar(bool chegada);
+    void executarEventos();
+    void executarTrabalho();
+    bool tentarConectar();
+
+    libusb_context* contexto = nullptr;
+    int handleHotplug = 0;
+    std::thread threadEventos;
+    std::thread threadTrabalho;
+    std::atomic<bool> rodando{false};
+    std::atomic<PresencaDispositivo> estado{PresencaDispositivo::Desconhecida};
+    std::atomic<int> presentes{0};
+
+    std::mutex mutexFila;
+    std::condition_variable cvFila;
+    std::deque<bool> fila; // true = chegada, false = remoção
+
+    AoConectar conectar;
+    AoDesconectar desconectar;
+};
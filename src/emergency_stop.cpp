@@ -0,0 +1,237 @@
+#include "emergency_stop.h"
+#include "logger.h"
+#include "process_launcher.h"
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+Registro::Modulo g_log{"parada"};
+
+constexpr int PRIORIDADE_EMERGENCIA = 90;                      // Acima dos servos (80)
+constexpr uint64_t PRAZO_FORCA_ZERO_NS = 100ull * 1000 * 1000; // Espera pela confirmação do servo
+constexpr uint64_t PRAZO_TERMINO_NS = 500ull * 1000 * 1000;    // SIGTERM -> SIGKILL nos jogos
+constexpr uint64_t PRAZO_FATAL_NS = 3ull * 1000 * 1000;        // Espera máxima dentro do tratador fatal
+constexpr int SINAIS_PARADA[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+constexpr int SINAIS_FATAIS[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+constexpr uint64_t EVENTO_ACIONAR = 1;
+
+std::atomic<bool> g_ativa{false};
+std::atomic<uint64_t> g_inicioNs{0};       // Instante do sinal (primeiro acionamento)
+std::atomic<uint64_t> g_forcaZeroNs{0};    // Primeira força zero aplicada depois dele
+std::atomic<int> g_motivo{0};
+std::atomic<bool> g_tratada{false};        // A thread de emergência já executou a parada
+ParadaEmergencia::AoParar g_aoParar = nullptr;
+int g_fdSinais = -1;
+int g_fdEventos = -1;
+
+uint64_t agoraNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts); // Async-signal-safe
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void dormirNs(uint64_t ns) {
+    timespec ts{ (time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull) };
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {}
+}
+
+// Marca a parada; retorna false se ela já estava ativa
+bool marcar(int motivo) {
+    uint64_t esperado = 0;
+    bool primeira = g_inicioNs.compare_exchange_strong(esperado, agoraNs());
+    if (primeira) g_motivo.store(motivo, std::memory_order_relaxed);
+    g_ativa.store(true, std::memory_order_release);
+    return primeira;
+}
+
+// Descrição do sinal; strsignal não é thread-safe
+const char* descricaoSinal(int sinal) {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 32)
+    if (const char* descricao = sigdescr_np(sinal)) return descricao;
+#endif
+    return "desconhecido";
+}
+
+// Pilha alternativa por thread (sigaltstack vale só para a thread que o chama)
+struct PilhaAlternativa {
+    static constexpr size_t TAMANHO = 64 * 1024;
+    char* memoria = nullptr;
+
+    PilhaAlternativa() {
+        memoria = new (std::nothrow) char[TAMANHO];
+        if (!memoria) return;
+        stack_t pilha{};
+        pilha.ss_sp = memoria;
+        pilha.ss_size = TAMANHO;
+        if (sigaltstack(&pilha, nullptr) != 0) {
+            delete[] memoria;
+            memoria = nullptr;
+        }
+    }
+    ~PilhaAlternativa() {
+        if (!memoria) return;
+        stack_t desligar{};
+        desligar.ss_flags = SS_DISABLE;
+        sigaltstack(&desligar, nullptr);
+        delete[] memoria;
+    }
+};
+
+// Escrita mínima para o tratador fatal: só write(2), sem buffers nem locale
+void escrever(const char* texto) {
+    ssize_t r = write(STDERR_FILENO, texto, std::strlen(texto));
+    (void)r;
+}
+
+void escreverNumero(uint64_t valor) {
+    char buf[24];
+    int i = sizeof(buf);
+    buf[--i] = '\0';
+    do { buf[--i] = (char)('0' + valor % 10); valor /= 10; } while (valor && i > 0);
+    escrever(buf + i);
+}
+
+void tratadorFatal(int sinal) {
+    marcar(sinal);
+    escrever("\nPARADA DE EMERGÊNCIA! Falha fatal, sinal ");
+    escreverNumero((uint64_t)sinal);
+    escrever("\n");
+    // Dá uma chance ao servo de aplicar força zero (a falha pode ter sido nele);
+    // nanosleep é async-signal-safe e não rouba o núcleo do servo
+    const uint64_t inicio = g_inicioNs.load();
+    while (g_forcaZeroNs.load() == 0 && agoraNs() - inicio < PRAZO_FATAL_NS) dormirNs(50 * 1000);
+    const uint64_t zero = g_forcaZeroNs.load();
+    if (zero) {
+        escrever("Força zero aplicada em ");
+        escreverNumero((zero - inicio) / 1000);
+        escrever(" us\n");
+    } else {
+        escrever("AVISO: Nenhum servo confirmou força zero.\n");
+    }
+    Processos::sinalizarTodos(SIGKILL);
+    // SA_RESETHAND já restaurou a ação padrão: o sinal reenviado derruba o processo (core dump)
+    raise(sinal);
+}
+
+void executarParada(int motivo) {
+    marcar(motivo);
+    if (g_tratada.exchange(true)) {
+        // Segundo sinal durante a parada: não espera mais os jogos
+        int grupos = Processos::sinalizarTodos(SIGKILL);
+        Registro::aviso(g_log, "Parada de emergência repetida (sinal {}): {} grupo(s) de jogos forçados (SIGKILL).", motivo, grupos);
+        return;
+    }
+    const uint64_t inicio = g_inicioNs.load();
+    int grupos = Processos::sinalizarTodos(SIGTERM);
+
+    while (g_forcaZeroNs.load(std::memory_order_acquire) == 0 && agoraNs() - inicio < PRAZO_FORCA_ZERO_NS) dormirNs(50 * 1000);
+    const uint64_t zero = g_forcaZeroNs.load(std::memory_order_acquire);
+    // Só depois da força zero: o primeiro registro da thread aloca o anel dela
+    if (motivo > 0) Registro::aviso(g_log, "PARADA DE EMERGÊNCIA! Motivo: sinal {} ({})", motivo, descricaoSinal(motivo));
+    else Registro::aviso(g_log, "PARADA DE EMERGÊNCIA! Motivo: interface");
+    if (zero) Registro::info(g_log, "Força zero aplicada em {} us.", (zero - inicio) / 1000);
+    else Registro::aviso(g_log, "Nenhum servo confirmou força zero em {} ms (dispositivo parado?).", PRAZO_FORCA_ZERO_NS / 1000000);
+
+    if (grupos > 0) {
+        while (Processos::jogosAtivos() > 0 && agoraNs() - inicio < PRAZO_TERMINO_NS) dormirNs(5 * 1000 * 1000);
+        int restantes = Processos::sinalizarTodos(SIGKILL);
+        const uint64_t us = (agoraNs() - inicio) / 1000;
+        if (restantes > 0) Registro::aviso(g_log, "Jogos terminados: {} grupo(s), {} forçado(s) com SIGKILL, em {} us.", grupos, restantes, us);
+        else Registro::info(g_log, "Jogos terminados: {} grupo(s), em {} us.", grupos, us);
+    }
+    if (g_aoParar) g_aoParar();
+}
+
+void executarThread() {
+    ParadaEmergencia::prepararThread();
+    // Acima dos servos para que a parada não espere por eles; sem privilégio segue normal
+    sched_param param{};
+    param.sched_priority = PRIORIDADE_EMERGENCIA;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    pollfd fds[2] = { { g_fdSinais, POLLIN, 0 }, { g_fdEventos, POLLIN, 0 } };
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            Registro::erro(g_log, "Parada de emergência: poll falhou: {}", std::strerror(errno));
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            signalfd_siginfo info;
+            if (read(g_fdSinais, &info, sizeof(info)) == (ssize_t)sizeof(info)) executarParada((int)info.ssi_signo);
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t eventos = 0;
+            if (read(g_fdEventos, &eventos, sizeof(eventos)) == (ssize_t)sizeof(eventos)) executarParada(g_motivo.load());
+        }
+    }
+}
+
+} // namespace
+
+bool ParadaEmergencia::instalar(AoParar aoParar) {
+    g_aoParar = aoParar;
+
+    // Sinais de parada: bloqueados aqui e herdados por toda thread criada depois
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    for (int s : SINAIS_PARADA) sigaddset(&sinais, s);
+    // Roda antes de Registro::iniciar e a falha encerra o launcher: erros direto no stderr
+    if (pthread_sigmask(SIG_BLOCK, &sinais, nullptr) != 0) {
+        std::cerr << "ERRO: Não foi possível bloquear os sinais de parada." << std::endl;
+        return false;
+    }
+    g_fdSinais = signalfd(-1, &sinais, SFD_CLOEXEC);
+    g_fdEventos = eventfd(0, EFD_CLOEXEC);
+    if (g_fdSinais < 0 || g_fdEventos < 0) {
+        std::cerr << "ERRO: Parada de emergência indisponível: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Falhas fatais: tratador restrito, numa pilha alternativa (estouro de pilha também chega)
+    prepararThread();
+    struct sigaction acao{};
+    acao.sa_handler = tratadorFatal;
+    acao.sa_flags = SA_RESETHAND | SA_ONSTACK;
+    sigemptyset(&acao.sa_mask);
+    for (int s : SINAIS_FATAIS) sigaction(s, &acao, nullptr);
+
+    // Vive até o fim do processo, bloqueada em poll
+    std::thread(executarThread).detach();
+    return true;
+}
+
+void ParadaEmergencia::prepararThread() {
+    thread_local PilhaAlternativa pilha;
+    (void)pilha;
+}
+
+bool ParadaEmergencia::ativa() {
+    return g_ativa.load(std::memory_order_relaxed);
+}
+
+void ParadaEmergencia::confirmarForcaZero() {
+    if (g_forcaZeroNs.load(std::memory_order_relaxed) != 0) return;
+    uint64_t esperado = 0;
+    g_forcaZeroNs.compare_exchange_strong(esperado, agoraNs(), std::memory_order_release);
+}
+
+void ParadaEmergencia::acionar(int motivo) {
+    // Marca já aqui: o servo zera a força sem esperar a thread de emergência acordar
+    marcar(motivo);
+    uint64_t evento = EVENTO_ACIONAR;
+    ssize_t r = write(g_fdEventos, &evento, sizeof(evento));
+    (void)r;
+}
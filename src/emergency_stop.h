@@ -0,0 +1,40 @@
+// emergency_stop.h
+#pragma once
+#include <cstdint>
+
+// Parada de emergência.
+//
+// SIGINT/SIGTERM/SIGHUP/SIGQUIT ficam bloqueados em todas as threads e chegam
+// por um signalfd a uma thread dedicada (prioridade de tempo real quando
+// permitido), fora de qualquer tratador de sinal. Ela marca a parada, que as
+// threads servo leem a cada iteração e respondem zerando a força; depois
+// termina os grupos de processos dos jogos, registra a latência entre o sinal
+// e a primeira força zero aplicada, e só então pede o encerramento da UI.
+//
+// Falhas fatais (SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT) têm um tratador
+// async-signal-safe que faz o mesmo com o que é permitido ali (atômicos,
+// clock_gettime, killpg, write) antes de deixar o processo morrer. Ele roda
+// numa pilha alternativa, que é por thread: cada thread que pode falhar
+// (servo, trabalhadoras) chama prepararThread() ao começar.
+namespace ParadaEmergencia {
+    using AoParar = void (*)();
+
+    // Deve ser chamada no início de main, antes de criar qualquer thread,
+    // para que todas herdem a máscara de sinais. aoParar roda na thread de
+    // emergência depois que a força foi zerada e os jogos sinalizados.
+    bool instalar(AoParar aoParar);
+
+    // Pilha alternativa da thread atual para o tratador fatal (um estouro de
+    // pilha também chega a ele). Liberada quando a thread termina. instalar()
+    // já a prepara para a thread que a chama.
+    void prepararThread();
+
+    // Lido pelas threads servo a cada iteração (um load relaxado).
+    bool ativa();
+    // A thread servo chama logo após aplicar força zero com a parada ativa;
+    // só a primeira chamada conta para a latência.
+    void confirmarForcaZero();
+
+    // Dispara a parada programaticamente (ex.: botão na UI).
+    void acionar(int motivo);
+}
@@ -0,0 +1,233 @@
+#include "event_loop.h"
+#include "logger.h"
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define GLFW_INCLUDE_NONE
+#define GLFW_EXPOSE_NATIVE_X11
+#include <GLFW/glfw3.h>
+#include <GLFW/glfw3native.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace {
+
+Registro::Modulo g_log{"eventos"};
+
+constexpr int MAX_EVENTOS = 32; // Descritores despachados por volta de aguardar()
+
+itimerspec especificacao(std::chrono::nanoseconds primeiro, std::chrono::nanoseconds periodo) {
+    auto converter = [](std::chrono::nanoseconds ns) {
+        return timespec{ (time_t)(ns.count() / 1000000000), (long)(ns.count() % 1000000000) };
+    };
+    itimerspec spec{};
+    // it_value zero desarmaria o timer: "agora" vira 1 ns
+    spec.it_value = converter(primeiro.count() > 0 ? primeiro : std::chrono::nanoseconds(1));
+    spec.it_interval = converter(periodo);
+    return spec;
+}
+
+} // namespace
+
+bool LacoEventos::iniciar() {
+    if (epollFd >= 0) return true;
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    eventoFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || eventoFd < 0) {
+        Registro::erro(g_log, "Laço de eventos indisponível: {}", std::strerror(errno));
+        encerrar();
+        return false;
+    }
+    return registrar(eventoFd, EPOLLIN, [this](uint32_t) {
+        uint64_t pedidos;
+        while (read(eventoFd, &pedidos, sizeof(pedidos)) > 0) {}
+    }, false);
+}
+
+void LacoEventos::encerrar() {
+    for (auto& par : entradas)
+        if (par.second->proprio) close(par.first);
+    entradas.clear();
+    observacoes.clear();
+    for (int* fd : { &inotifyFd, &eventoFd, &epollFd }) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+bool LacoEventos::registrar(int fd, uint32_t eventosEpoll, Tratador tratador, bool proprio) {
+    // O evento leva o número do registro junto do fd: um evento já colhido por
+    // epoll_wait para um fd fechado e reaproveitado nesta mesma volta não chega
+    // ao tratador novo
+    const uint32_t registro = proximoRegistro++;
+    epoll_event ev{};
+    ev.events = eventosEpoll;
+    ev.data.u64 = ((uint64_t)registro << 32) | (uint32_t)fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        Registro::erro(g_log, "epoll_ctl({}): {}", fd, std::strerror(errno));
+        return false;
+    }
+    auto entrada = std::make_shared<Entrada>();
+    entrada->tratador = std::move(tratador);
+    entrada->registro = registro;
+    entrada->proprio = proprio;
+    entradas[fd] = std::move(entrada);
+    return true;
+}
+
+bool LacoEventos::observarFd(int fd, uint32_t eventosEpoll, Tratador tratador) {
+    return registrar(fd, eventosEpoll, std::move(tratador), false);
+}
+
+void LacoEventos::removerFd(int fd) {
+    if (entradas.erase(fd)) epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void LacoEventos::fecharFd(int fd) {
+    auto it = entradas.find(fd);
+    if (it == entradas.end()) return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    entradas.erase(it);
+    close(fd);
+}
+
+bool LacoEventos::observarSinais(const sigset_t& sinais, AoSinal aoSinal) {
+    if (pthread_sigmask(SIG_BLOCK, &sinais, nullptr) != 0) return false;
+    int fd = signalfd(-1, &sinais, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        Registro::erro(g_log, "signalfd: {}", std::strerror(errno));
+        return false;
+    }
+    if (!registrar(fd, EPOLLIN, [fd, aoSinal = std::move(aoSinal)](uint32_t) {
+            signalfd_siginfo info;
+            while (read(fd, &info, sizeof(info)) == (ssize_t)sizeof(info)) aoSinal(info);
+        }, true)) {
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool LacoEventos::observarProcesso(pid_t pid, AoTerminar aoTerminar, AoColher antesDeColher) {
+    int fd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (fd < 0) return false;
+    if (!registrar(fd, EPOLLIN, [this, fd, pid, aoTerminar = std::move(aoTerminar), antesDeColher](uint32_t) {
+            siginfo_t info{};
+            int espera;
+            while ((espera = waitid(P_PID, (id_t)pid, &info, WEXITED | WNOHANG | WNOWAIT)) < 0 && errno == EINTR) {}
+            if (espera == 0 && info.si_pid == 0) return; // Ainda não é zumbi
+            if (espera == 0 && antesDeColher) antesDeColher(pid);
+            int status = 0;
+            while (waitpid(pid, &status, WNOHANG) < 0 && errno == EINTR) {}
+            aoTerminar(pid, status);
+            fecharFd(fd);
+        }, true)) {
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+int LacoEventos::observarCaminho(const std::string& caminho, uint32_t mascara, AoMudar aoMudar) {
+    if (inotifyFd < 0) {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0 || !registrar(inotifyFd, EPOLLIN, [this](uint32_t) { lerInotify(); }, false)) {
+            Registro::erro(g_log, "inotify: {}", std::strerror(errno));
+            if (inotifyFd >= 0) close(inotifyFd);
+            inotifyFd = -1;
+            return -1;
+        }
+    }
+    int watch = inotify_add_watch(inotifyFd, caminho.c_str(), mascara);
+    if (watch < 0) {
+        Registro::aviso(g_log, "Não foi possível observar {}: {}", caminho, std::strerror(errno));
+        return -1;
+    }
+    observacoes[watch] = std::move(aoMudar);
+    return watch;
+}
+
+void LacoEventos::removerObservacao(int watch) {
+    if (inotifyFd >= 0 && observacoes.erase(watch)) inotify_rm_watch(inotifyFd, watch);
+}
+
+void LacoEventos::lerInotify() {
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t lidos = read(inotifyFd, buffer, sizeof(buffer));
+        if (lidos <= 0) return;
+        for (ssize_t pos = 0; pos < lidos;) {
+            const inotify_event* e = reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += (ssize_t)(sizeof(inotify_event) + e->len);
+            auto it = observacoes.find(e->wd);
+            if (it == observacoes.end()) continue;
+            AoMudar tratador = it->second; // Cópia: o tratador pode remover a observação
+            if (e->mask & IN_IGNORED) observacoes.erase(it); // Caminho removido: o watch não existe mais
+            tratador(*e);
+        }
+    }
+}
+
+int LacoEventos::criarTimer(std::chrono::nanoseconds primeiro, std::chrono::nanoseconds periodo, AoDisparar aoDisparar) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        Registro::erro(g_log, "timerfd: {}", std::strerror(errno));
+        return -1;
+    }
+    if (!registrar(fd, EPOLLIN, [fd, aoDisparar = std::move(aoDisparar)](uint32_t) {
+            uint64_t expiracoes = 0;
+            if (read(fd, &expiracoes, sizeof(expiracoes)) == (ssize_t)sizeof(expiracoes) && expiracoes > 0) aoDisparar();
+        }, true)) {
+        close(fd);
+        return -1;
+    }
+    rearmarTimer(fd, primeiro, periodo);
+    return fd;
+}
+
+bool LacoEventos::rearmarTimer(int timer, std::chrono::nanoseconds primeiro, std::chrono::nanoseconds periodo) {
+    itimerspec spec = especificacao(primeiro, periodo);
+    return timerfd_settime(timer, 0, &spec, nullptr) == 0;
+}
+
+void LacoEventos::acordar() {
+    uint64_t um = 1;
+    ssize_t r = write(eventoFd, &um, sizeof(um));
+    (void)r;
+}
+
+int LacoEventos::aguardar(int timeoutMs) {
+    epoll_event prontos[MAX_EVENTOS];
+    int n = epoll_wait(epollFd, prontos, MAX_EVENTOS, timeoutMs);
+    if (n < 0) return 0; // EINTR
+    for (int i = 0; i < n; ++i) {
+        const int fd = (int)(uint32_t)prontos[i].data.u64;
+        const uint32_t registro = (uint32_t)(prontos[i].data.u64 >> 32);
+        auto it = entradas.find(fd);
+        // Removido por um tratador anterior nesta volta, ou fd reaproveitado por outro registro
+        if (it == entradas.end() || it->second->registro != registro) continue;
+        std::shared_ptr<Entrada> entrada = it->second;
+        entrada->tratador(prontos[i].events);
+    }
+    return n;
+}
+
+int descritorServidorGrafico() {
+    Display* display = glfwGetX11Display();
+    return display ? ConnectionNumber(display) : -1;
+}
+
+bool eventosGraficosPendentes() {
+    Display* display = glfwGetX11Display();
+    return display && XEventsQueued(display, QueuedAfterFlush) > 0;
+}
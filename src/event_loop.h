@@ -0,0 +1,99 @@
+// event_loop.h
+#pragma once
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/signalfd.h>
+#include <sys/types.h>
+#include <unordered_map>
+
+struct inotify_event;
+
+// Laço de eventos da thread da UI, sobre epoll.
+//
+// Tudo o que pode acordar a interface vira um descritor: a conexão com o
+// servidor gráfico, sinais (signalfd), término de filhos (pidfd), mudanças em
+// arquivos (inotify), temporizadores (timerfd) e pedidos de outras threads
+// (eventfd, via acordar()). A thread da UI só dorme em aguardar() e só acorda
+// quando um deles fica pronto — sem polling e sem uma thread por filho.
+//
+// Os tratadores rodam na thread que chama aguardar(). Nenhum método, exceto
+// acordar(), é thread-safe.
+class LacoEventos {
+public:
+    using Tratador = std::function<void(uint32_t eventosEpoll)>;
+    using AoSinal = std::function<void(const signalfd_siginfo&)>;
+    using AoTerminar = std::function<void(pid_t pid, int status)>;
+    using AoColher = void (*)(pid_t pid);
+    using AoMudar = std::function<void(const inotify_event&)>;
+    using AoDisparar = std::function<void()>;
+
+    LacoEventos() = default;
+    LacoEventos(const LacoEventos&) = delete;
+    LacoEventos& operator=(const LacoEventos&) = delete;
+    ~LacoEventos() { encerrar(); }
+
+    bool iniciar();
+    void encerrar();
+
+    // Descritor qualquer (o laço não o fecha).
+    bool observarFd(int fd, uint32_t eventosEpoll, Tratador tratador);
+    void removerFd(int fd);
+
+    // Bloqueia os sinais na thread atual e os entrega por signalfd. Para valer no
+    // processo inteiro, chame antes de criar outras threads.
+    bool observarSinais(const sigset_t& sinais, AoSinal aoSinal);
+
+    // Colhe o filho quando ele termina (pidfd_open, Linux 5.3+). Retorna false se
+    // pidfd não for suportado; o chamador decide como esperar então.
+    // antesDeColher roda com o filho já zumbi, antes do waitpid: o pid dele (e o
+    // pgid, se for líder de grupo) ainda não pode ser reutilizado.
+    bool observarProcesso(pid_t pid, AoTerminar aoTerminar, AoColher antesDeColher = nullptr);
+
+    // Um inotify para todos os caminhos. Retorna o watch, ou -1. O tratador
+    // recebe também IN_IGNORED (caminho removido ou desmontado); depois dele a
+    // observação já não existe.
+    int observarCaminho(const std::string& caminho, uint32_t mascara, AoMudar aoMudar);
+    void removerObservacao(int watch);
+
+    // Temporizador (timerfd, CLOCK_MONOTONIC). periodo 0 = dispara uma vez.
+    // rearmarTimer reprograma um existente (ex.: debounce).
+    int criarTimer(std::chrono::nanoseconds primeiro, std::chrono::nanoseconds periodo, AoDisparar aoDisparar);
+    bool rearmarTimer(int timer, std::chrono::nanoseconds primeiro, std::chrono::nanoseconds periodo = std::chrono::nanoseconds(0));
+    void removerTimer(int timer) { fecharFd(timer); }
+
+    // Thread-safe e async-signal-safe: faz o aguardar() atual (ou o próximo) retornar.
+    void acordar();
+
+    // Espera até timeoutMs (-1 = sem limite) e despacha os tratadores prontos.
+    // Retorna quantos descritores ficaram prontos (0 = tempo esgotado).
+    int aguardar(int timeoutMs);
+
+private:
+    struct Entrada {
+        Tratador tratador;
+        uint32_t registro = 0; // Número do registro: distingue um fd reaproveitado
+        bool proprio = false;  // Criado pelo laço (timerfd, pidfd...): fechado ao remover
+    };
+
+    bool registrar(int fd, uint32_t eventosEpoll, Tratador tratador, bool proprio);
+    void fecharFd(int fd);
+    void lerInotify();
+
+    int epollFd = -1;
+    int eventoFd = -1;
+    int inotifyFd = -1;
+    uint32_t proximoRegistro = 1;
+    // shared_ptr: um tratador pode remover a si mesmo (ou outros) durante o despacho
+    std::unordered_map<int, std::shared_ptr<Entrada>> entradas;
+    std::unordered_map<int, AoMudar> observacoes; // watch do inotify -> tratador
+};
+
+// Descritor da conexão com o servidor X da janela GLFW, ou -1 (Wayland ou outra
+// plataforma); eventosGraficosPendentes() diz se o Xlib já leu eventos para a
+// fila (o descritor não fica legível de novo por eles).
+int descritorServidorGrafico();
+bool eventosGraficosPendentes();
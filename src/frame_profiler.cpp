@@ -0,0 +1,225 @@
+#include "frame_profiler.h"
+#include "alloc_tracker.h"
+#include "imgui.h"
+#include "logger.h"
+#include "metrics.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+Registro::Modulo g_log{"perfilador"};
+
+Metricas::Resumo g_metricaQuadro{"jardim_frame_time_seconds", "Duração (tempo de parede) de cada quadro da UI, sem a espera por eventos."};
+
+const char* NOMES_FASES[PerfiladorQuadro::FASES] = {
+    "Eventos", "Filtro", "Cards", "ImGui::Render", "RenderDrawData", "Swap"
+};
+
+double msDesde(std::chrono::steady_clock::time_point inicio, std::chrono::steady_clock::time_point fim) {
+    return std::chrono::duration<double, std::milli>(fim - inicio).count();
+}
+
+uint64_t ns(std::chrono::steady_clock::time_point t) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+} // namespace
+
+void PerfiladorQuadro::inicializarGpu() {
+    if (!(GLEW_VERSION_3_3 || GLEW_ARB_timer_query)) {
+        Registro::aviso(g_log, "GL_TIME_ELAPSED indisponível; perfilador medirá apenas a CPU.");
+        return;
+    }
+    glGenQueries(QUERIES_GPU, queries);
+}
+
+void PerfiladorQuadro::liberarGpu() {
+    if (queries[0] != 0) glDeleteQueries(QUERIES_GPU, queries);
+    std::fill(std::begin(queries), std::end(queries), 0u);
+    std::fill(std::begin(queryPendente), std::end(queryPendente), false);
+    queryAtual = 0;
+    gpuMedindo = false;
+}
+
+const char* PerfiladorQuadro::nomeFase(int fase) {
+    return fase >= 0 && fase < FASES ? NOMES_FASES[fase] : "Quadro";
+}
+
+void PerfiladorQuadro::iniciarQuadro() {
+    inicioQuadro = Relogio::now();
+    std::fill(std::begin(acumuladoFase), std::end(acumuladoFase), 0.0);
+    alocacoesInicio = ContadorAlocacoes::alocacoesThread();
+    bytesInicio = ContadorAlocacoes::bytesThread();
+    medirContadores = ContadoresCpu::ler(inicioContadoresQuadro);
+    if (medirContadores) std::fill(std::begin(acumuladoContadores), std::end(acumuladoContadores), AmostraContadores());
+}
+
+void PerfiladorQuadro::encerrarQuadro() {
+    Relogio::time_point fim = Relogio::now();
+    if (Rastreamento::ativo()) Rastreamento::span("Quadro", "quadro", ns(inicioQuadro), ns(fim));
+    for (int f = 0; f < FASES; ++f) historicoFase[f][posicao] = (float)acumuladoFase[f];
+    AmostraContadores fimContadores;
+    if (medirContadores && ContadoresCpu::ler(fimContadores)) {
+        for (int f = 0; f < FASES; ++f) {
+            historicoContadores[f][posicao] = acumuladoContadores[f];
+            totalContadores[f] += acumuladoContadores[f];
+        }
+        historicoContadores[FASES][posicao] = fimContadores - inicioContadoresQuadro;
+        totalContadores[FASES] += historicoContadores[FASES][posicao];
+    }
+    historicoQuadro[posicao] = (float)msDesde(inicioQuadro, fim);
+    g_metricaQuadro.registrar(ns(fim) - ns(inicioQuadro));
+    historicoAlocacoes[posicao] = (uint32_t)(ContadorAlocacoes::alocacoesThread() - alocacoesInicio);
+    historicoBytes[posicao] = ContadorAlocacoes::bytesThread() - bytesInicio;
+    posicao = (posicao + 1) % HISTORICO;
+    if (preenchidos < HISTORICO) preenchidos++;
+    totalQuadros++;
+}
+
+void PerfiladorQuadro::iniciarFase(FaseQuadro fase) {
+    inicioFase[(int)fase] = Relogio::now();
+    if (medirContadores) ContadoresCpu::ler(inicioContadoresFase[(int)fase]);
+}
+
+void PerfiladorQuadro::encerrarFase(FaseQuadro fase) {
+    Relogio::time_point fim = Relogio::now();
+    acumuladoFase[(int)fase] += msDesde(inicioFase[(int)fase], fim);
+    AmostraContadores fimContadores;
+    if (medirContadores && ContadoresCpu::ler(fimContadores))
+        acumuladoContadores[(int)fase] += fimContadores - inicioContadoresFase[(int)fase];
+    if (Rastreamento::ativo()) Rastreamento::span(NOMES_FASES[(int)fase], "quadro", ns(inicioFase[(int)fase]), ns(fim));
+}
+
+void PerfiladorQuadro::iniciarGpu() {
+    if (!gpuDisponivel()) return;
+    // Colhe, da mais antiga para a mais nova, as queries cujo resultado já está
+    // pronto. Os resultados saem em ordem; na primeira ainda pendente paramos.
+    for (int k = 0; k < QUERIES_GPU; k++) {
+        int i = (queryAtual + k) % QUERIES_GPU;
+        if (!queryPendente[i]) continue;
+        GLint pronto = 0;
+        glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &pronto);
+        if (!pronto) break;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+        historicoGpu[posicaoGpu] = (float)(ns / 1.0e6);
+        posicaoGpu = (posicaoGpu + 1) % HISTORICO;
+        if (preenchidosGpu < HISTORICO) preenchidosGpu++;
+        queryPendente[i] = false;
+    }
+    // Todo o anel ainda em voo (GPU atrasada vários quadros): não reutilizamos
+    // uma query pendente; este quadro fica sem medição de GPU (sem stall).
+    gpuMedindo = !queryPendente[queryAtual];
+    if (gpuMedindo) glBeginQuery(GL_TIME_ELAPSED, queries[queryAtual]);
+}
+
+void PerfiladorQuadro::encerrarGpu() {
+    if (!gpuMedindo) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    queryPendente[queryAtual] = true;
+    queryAtual = (queryAtual + 1) % QUERIES_GPU;
+    gpuMedindo = false;
+}
+
+void PerfiladorQuadro::zerarContadores() {
+    std::fill(std::begin(totalContadores), std::end(totalContadores), AmostraContadores());
+}
+
+float PerfiladorQuadro::percentil(const float* historico, int quantidade, float p) const {
+    if (quantidade <= 0) return 0.0f;
+    std::copy(historico, historico + quantidade, rascunho);
+    int k = (int)((p / 100.0f) * (quantidade - 1) + 0.5f);
+    std::nth_element(rascunho, rascunho + k, rascunho + quantidade);
+    return rascunho[k];
+}
+
+float PerfiladorQuadro::percentilCpu(int fase, float p) const {
+    return percentil(fase < 0 ? historicoQuadro : historicoFase[fase], preenchidos, p);
+}
+
+float PerfiladorQuadro::percentilGpu(float p) const {
+    return percentil(historicoGpu, preenchidosGpu, p);
+}
+
+void PerfiladorQuadro::desenharOverlay(bool* aberto) {
+    ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 20.0f, viewport->WorkPos.y + 40.0f),
+                            ImGuiCond_FirstUseEver, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Perfilador de Quadros (F3)", aberto, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav)) {
+        ImGui::End();
+        return;
+    }
+
+    char legenda[64];
+    float p50 = percentilCpu(-1, 50.0f), p99 = percentilCpu(-1, 99.0f);
+    snprintf(legenda, sizeof(legenda), "CPU p50 %.2f ms  p99 %.2f ms", p50, p99);
+    ImGui::PlotHistogram("##quadro", historicoQuadro, HISTORICO, posicao, legenda, 0.0f, std::max(p99 * 1.5f, 1.0f), ImVec2(320, 60));
+
+    if (gpuDisponivel()) {
+        float g50 = percentilGpu(50.0f), g99 = percentilGpu(99.0f);
+        snprintf(legenda, sizeof(legenda), "GPU p50 %.2f ms  p99 %.2f ms", g50, g99);
+        ImGui::PlotHistogram("##gpu", historicoGpu, HISTORICO, posicaoGpu, legenda, 0.0f, std::max(g99 * 1.5f, 0.5f), ImVec2(320, 60));
+    } else {
+        ImGui::TextDisabled("GPU: timer query indisponível");
+    }
+
+    if (ImGui::BeginTable("##fases", 4)) {
+        ImGui::TableSetupColumn("Fase");
+        ImGui::TableSetupColumn("Último");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        int ultimo = (posicao + HISTORICO - 1) % HISTORICO;
+        for (int f = 0; f < FASES; ++f) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(NOMES_FASES[f]);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", historicoFase[f][ultimo]);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", percentilCpu(f, 50.0f));
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", percentilCpu(f, 99.0f));
+        }
+        ImGui::EndTable();
+    }
+    for (int f = 0; f < FASES; ++f) {
+        ImGui::PlotLines(NOMES_FASES[f], historicoFase[f], HISTORICO, posicao, nullptr, 0.0f, FLT_MAX, ImVec2(220, 24));
+    }
+
+    if (ContadorAlocacoes::ativo()) {
+        int ultimo = (posicao + HISTORICO - 1) % HISTORICO;
+        uint32_t maximo = *std::max_element(historicoAlocacoes, historicoAlocacoes + std::max(preenchidos, 1));
+        ImGui::Text("Alocações no quadro: %u (%llu bytes), máx %u", historicoAlocacoes[ultimo],
+                    (unsigned long long)historicoBytes[ultimo], maximo);
+    }
+
+    if (!ContadoresCpu::habilitado()) {
+        ImGui::TextDisabled("Contadores de hardware: %s", ContadoresCpu::motivo().c_str());
+    } else {
+        // Somas do histórico: razões de somas, não médias de razões
+        if (ImGui::BeginTable("##contadores", 4)) {
+            ImGui::TableSetupColumn("Fase");
+            ImGui::TableSetupColumn("IPC");
+            ImGui::TableSetupColumn("Cache MPKI");
+            ImGui::TableSetupColumn("Desvio MPKI");
+            ImGui::TableHeadersRow();
+            for (int f = 0; f <= FASES; ++f) {
+                AmostraContadores soma;
+                for (int i = 0; i < preenchidos; ++i) soma += historicoContadores[f][i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(nomeFase(f));
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", soma.ipc());
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", soma.faltasCacheMpki());
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", soma.errosDesvioMpki());
+            }
+            ImGui::EndTable();
+        }
+        if (ImGui::CollapsingHeader("Inicialização")) {
+            for (const auto& etapa : ContadoresCpu::etapas()) {
+                ImGui::Text("%-22s %8.2f ms  IPC %.2f  cache %.2f  desvio %.2f MPKI", etapa.nome, etapa.ms,
+                            etapa.contadores.ipc(), etapa.contadores.faltasCacheMpki(), etapa.contadores.errosDesvioMpki());
+            }
+        }
+    }
+    ImGui::End();
+}
@@ -0,0 +1,110 @@
+// frame_profiler.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <GL/glew.h>
+#include "perf_counters.h"
+
+// Fases de um quadro de executarLoop medidas pelo perfilador.
+enum class FaseQuadro : int {
+    Eventos = 0,     // glfwPollEvents
+    Filtro,          // filtro de jogos + layout da grade
+    Cards,           // submissão dos cards ao ImGui
+    Render,          // ImGui::Render
+    RenderDrawData,  // ImGui_ImplOpenGL3_RenderDrawData
+    Swap,            // glfwSwapBuffers
+    Count
+};
+
+// Perfilador de quadros: tempo de CPU por fase (steady_clock) e tempo de GPU
+// via queries GL_TIME_ELAPSED num anel, para nunca esperar pela GPU.
+// Mantém um histórico circular e desenha um overlay com histogramas e p50/p99.
+// Com --perf-counters, lê também os contadores de hardware da thread nas
+// fronteiras das fases e mostra IPC e faltas por mil instruções. Com
+// ENABLE_ALLOC_TRACKING, mostra as alocações no heap de cada quadro.
+class PerfiladorQuadro {
+public:
+    static constexpr int HISTORICO = 240;
+    static constexpr int FASES = (int)FaseQuadro::Count;
+
+    // Precisa de contexto OpenGL ativo. Sem GL 3.3 / ARB_timer_query, mede só a CPU.
+    void inicializarGpu();
+    void liberarGpu();
+    bool gpuDisponivel() const { return queries[0] != 0; }
+
+    void iniciarQuadro();
+    void encerrarQuadro();
+
+    void iniciarFase(FaseQuadro fase);
+    void encerrarFase(FaseQuadro fase);
+
+    // Delimitam o trabalho de GPU do quadro (clear + RenderDrawData).
+    void iniciarGpu();
+    void encerrarGpu();
+
+    void desenharOverlay(bool* aberto);
+
+    // Percentil (0..100) do histórico, em milissegundos. 'fase' < 0 = quadro inteiro.
+    float percentilCpu(int fase, float p) const;
+    float percentilGpu(float p) const;
+    uint64_t quadros() const { return totalQuadros; }
+
+    // Contadores somados desde o início (ou zerarContadores). 'fase' < 0 = quadro inteiro.
+    const AmostraContadores& contadoresTotais(int fase) const { return totalContadores[fase < 0 ? FASES : fase]; }
+    void zerarContadores();
+
+    static const char* nomeFase(int fase);
+
+private:
+    using Relogio = std::chrono::steady_clock;
+
+    float percentil(const float* historico, int quantidade, float p) const;
+
+    Relogio::time_point inicioQuadro;
+    Relogio::time_point inicioFase[FASES];
+    double acumuladoFase[FASES] = {};  // ms acumulados no quadro atual
+
+    float historicoFase[FASES][HISTORICO] = {};
+    float historicoQuadro[HISTORICO] = {};
+    float historicoGpu[HISTORICO] = {};
+    int posicao = 0;          // Próxima posição a escrever nos históricos
+    int preenchidos = 0;      // Quantas posições válidas (até HISTORICO)
+    int posicaoGpu = 0;
+    int preenchidosGpu = 0;
+    uint64_t totalQuadros = 0;
+
+    // Alocações da thread da UI durante o quadro (ENABLE_ALLOC_TRACKING)
+    uint64_t alocacoesInicio = 0;
+    uint64_t bytesInicio = 0;
+    uint32_t historicoAlocacoes[HISTORICO] = {};
+    uint64_t historicoBytes[HISTORICO] = {};
+
+    // Índice FASES = quadro inteiro
+    bool medirContadores = false;
+    AmostraContadores inicioContadoresQuadro;
+    AmostraContadores inicioContadoresFase[FASES];
+    AmostraContadores acumuladoContadores[FASES];
+    AmostraContadores historicoContadores[FASES + 1][HISTORICO];
+    AmostraContadores totalContadores[FASES + 1];
+
+    // Anel de queries: uma só é reutilizada depois que seu resultado foi lido
+    static constexpr int QUERIES_GPU = 4;
+    GLuint queries[QUERIES_GPU] = {};
+    bool queryPendente[QUERIES_GPU] = {};
+    int queryAtual = 0;
+    bool gpuMedindo = false;   // glBeginQuery emitido neste quadro
+
+    mutable float rascunho[HISTORICO]; // Cópia para nth_element sem alocar
+};
+
+// Mede uma fase no escopo atual.
+class EscopoFase {
+public:
+    EscopoFase(PerfiladorQuadro& p, FaseQuadro f) : perfilador(p), fase(f) { perfilador.iniciarFase(fase); }
+    ~EscopoFase() { perfilador.encerrarFase(fase); }
+    EscopoFase(const EscopoFase&) = delete;
+    EscopoFase& operator=(const EscopoFase&) = delete;
+private:
+    PerfiladorQuadro& perfilador;
+    FaseQuadro fase;
+};
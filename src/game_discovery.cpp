@@ -0,0 +1,140 @@
+#include "game_discovery.h"
+#include "logger.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string_view>
+#include <thread>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+Registro::Modulo g_log{"descoberta"};
+
+constexpr size_t TAMANHO_LOTE = 32 * 1024; // Bytes lidos do diretório por chamada
+
+constexpr const char* VARIAVEL_RAIZES = "JARDIM_GAMES_PATH";
+
+// Layout de struct linux_dirent64 do kernel (a glibc não o expõe)
+struct EntradaDiretorio {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+// Mesmo critério de fs::path::stem(): sem a última extensão, exceto em nomes como ".oculto"
+std::string_view nomeBase(std::string_view nome) {
+    size_t ponto = nome.rfind('.');
+    if (ponto == std::string_view::npos || ponto == 0 || nome == "..") return nome;
+    return nome.substr(0, ponto);
+}
+
+// Um statx só com tipo e modo; segue links simbólicos, como entry.is_regular_file()
+bool executavelRegular(int fdDir, const std::filesystem::path& dir, const char* nome) {
+    struct statx st;
+    if (statx(fdDir, nome, AT_STATX_DONT_SYNC, STATX_TYPE | STATX_MODE, &st) != 0) {
+        Registro::erro(g_log, "Erro ao verificar permissões para {}: {}", dir / nome, std::strerror(errno));
+        return false;
+    }
+    return S_ISREG(st.stx_mode) && (st.stx_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0;
+}
+
+} // namespace
+
+std::vector<std::filesystem::path> listarDesafios(const std::filesystem::path& dir,
+                                                  const std::unordered_map<std::string, GameConfig>& catalogo) {
+    EscopoRastreio rastreio("listarDesafios", "inicializacao", dir.c_str());
+    std::vector<std::filesystem::path> executaveis;
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) { Registro::aviso(g_log, "Diretório de desafios não encontrado: {}", dir); return executaveis; }
+
+    std::string chave; // Reaproveitada para a busca no catálogo
+    alignas(EntradaDiretorio) char lote[TAMANHO_LOTE];
+    for (;;) {
+        long lidos = syscall(SYS_getdents64, fd, lote, sizeof(lote));
+        if (lidos < 0) { Registro::erro(g_log, "Erro ao ler o diretório de desafios {}: {}", dir, std::strerror(errno)); break; }
+        if (lidos == 0) break;
+        for (long pos = 0; pos < lidos;) {
+            const EntradaDiretorio* e = reinterpret_cast<const EntradaDiretorio*>(lote + pos);
+            pos += e->d_reclen;
+            // Só o que pode ser (ou apontar para) um arquivo regular
+            if (e->d_type != DT_REG && e->d_type != DT_LNK && e->d_type != DT_UNKNOWN) continue;
+            chave.assign(nomeBase(e->d_name));
+            if (!catalogo.count(chave)) continue;
+            if (executavelRegular(fd, dir, e->d_name)) executaveis.push_back(dir / e->d_name);
+        }
+    }
+    close(fd);
+    return executaveis;
+}
+
+std::vector<GameInfo> descobrirJogos(const std::vector<std::filesystem::path>& raizes,
+                                     const std::unordered_map<std::string, GameConfig>& catalogo,
+                                     std::vector<VarreduraRaiz>& relatorio) {
+    EscopoRastreio rastreio("descobrirJogos", "inicializacao");
+    // Cada raiz escreve só no próprio slot: nenhuma sincronização além do contador
+    std::vector<std::vector<std::filesystem::path>> porRaiz(raizes.size());
+    relatorio.assign(raizes.size(), VarreduraRaiz{});
+    std::atomic<size_t> proxima{0};
+    auto trabalhar = [&] {
+        for (size_t i; (i = proxima.fetch_add(1)) < raizes.size();) {
+            auto inicio = std::chrono::steady_clock::now();
+            porRaiz[i] = listarDesafios(raizes[i], catalogo);
+            relatorio[i].raiz = raizes[i];
+            relatorio[i].encontrados = porRaiz[i].size();
+            relatorio[i].ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        }
+    };
+    // Uma raiz lenta (montagem de rede) ocupa só a sua thread; a chamadora também trabalha
+    const size_t threads = std::min(raizes.size(), MAX_THREADS_DESCOBERTA);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(trabalhar);
+    trabalhar();
+    for (auto& th : pool) th.join();
+
+    std::vector<GameInfo> jogos;
+    std::unordered_map<std::string, size_t> escolhidos; // Nome -> raiz que venceu
+    for (size_t i = 0; i < porRaiz.size(); ++i) {
+        auto& caminhos = porRaiz[i];
+        std::sort(caminhos.begin(), caminhos.end());
+        for (const auto& caminho : caminhos) {
+            std::string nome = caminho.stem().string();
+            if (!escolhidos.emplace(nome, i).second) { relatorio[i].sombreados++; continue; }
+            jogos.push_back(GameInfo{ caminho, catalogo.at(nome) });
+        }
+    }
+    return jogos;
+}
+
+std::vector<std::filesystem::path> raizesDeBusca(const std::vector<std::filesystem::path>& doArquivo,
+                                                 const std::filesystem::path& padrao) {
+    std::vector<std::filesystem::path> raizes;
+    auto adicionar = [&](const std::filesystem::path& raiz) {
+        if (raiz.empty()) return;
+        std::filesystem::path normalizada = raiz.lexically_normal();
+        if (!normalizada.has_filename() && normalizada.has_relative_path()) normalizada = normalizada.parent_path(); // "dir/" == "dir"
+        if (std::find(raizes.begin(), raizes.end(), normalizada) == raizes.end()) raizes.push_back(normalizada);
+    };
+    if (const char* ambiente = std::getenv(VARIAVEL_RAIZES)) {
+        std::string_view lista(ambiente);
+        for (size_t inicio = 0; inicio <= lista.size();) {
+            size_t fim = lista.find(':', inicio);
+            if (fim == std::string_view::npos) fim = lista.size();
+            adicionar(std::filesystem::path(std::string(lista.substr(inicio, fim - inicio))));
+            inicio = fim + 1;
+        }
+    }
+    for (const auto& raiz : doArquivo) adicionar(raiz);
+    if (raizes.empty()) adicionar(padrao);
+    return raizes;
+}
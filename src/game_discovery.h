@@ -0,0 +1,37 @@
+// game_discovery.h
+#pragma once
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "config_parser.h"
+
+// Procura em 'dir' os executáveis dos jogos do catálogo. O diretório é lido
+// em lotes (getdents64) e só entradas cujo nome base (sem extensão) está no
+// catálogo são examinadas, com no máximo um statx cada; d_type descarta
+// diretórios e afins sem stat. Retorna os caminhos de arquivos regulares com
+// algum bit de execução, na ordem do diretório.
+std::vector<std::filesystem::path> listarDesafios(const std::filesystem::path& dir,
+                                                  const std::unordered_map<std::string, GameConfig>& catalogo);
+
+// Resultado da varredura de uma raiz, para o relatório de inicialização.
+struct VarreduraRaiz {
+    std::filesystem::path raiz;
+    size_t encontrados = 0;  // Executáveis do catálogo nesta raiz
+    size_t sombreados = 0;   // Desses, quantos perderam para uma raiz de maior prioridade
+    double ms = 0.0;         // Tempo da varredura desta raiz
+};
+
+// Varre as raízes em paralelo (até MAX_THREADS_DESCOBERTA threads) e junta o
+// resultado de forma determinística: cada jogo vem da primeira raiz, na ordem
+// dada, que o contém, e os jogos ficam ordenados por raiz e depois por nome.
+constexpr size_t MAX_THREADS_DESCOBERTA = 4;
+std::vector<GameInfo> descobrirJogos(const std::vector<std::filesystem::path>& raizes,
+                                     const std::unordered_map<std::string, GameConfig>& catalogo,
+                                     std::vector<VarreduraRaiz>& relatorio);
+
+// Raízes de busca em ordem de prioridade: JARDIM_GAMES_PATH (separada por ':'),
+// depois "search_paths" do arquivo de configuração; sem nenhuma, 'padrao'.
+// Caminhos repetidos ficam só na posição de maior prioridade.
+std::vector<std::filesystem::path> raizesDeBusca(const std::vector<std::filesystem::path>& doArquivo,
+                                                 const std::filesystem::path& padrao);
@@ -0,0 +1,50 @@
+#include "game_filter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// Reaproveita a capacidade de 'destino'
+void paraMinusculas(const char* origem, std::string& destino) {
+    destino.assign(origem);
+    std::transform(destino.begin(), destino.end(), destino.begin(), [](unsigned char c){ return std::tolower(c); });
+}
+
+} // namespace
+
+bool FiltroJogos::atualizar(const std::vector<GameInfo>& jogos, const char* texto,
+                            const std::string& materia, const std::string& habilidade) {
+    if (valido && jogos.data() == jogosAtual && jogos.size() == quantidadeAtual &&
+        textoAtual == texto && materiaAtual == materia && habilidadeAtual == habilidade) {
+        return false;
+    }
+    if (!valido || jogos.data() != jogosAtual || jogos.size() != quantidadeAtual) {
+        descricoesMinusculas.resize(jogos.size());
+        materiasMinusculas.resize(jogos.size());
+        for (size_t i = 0; i < jogos.size(); ++i) {
+            paraMinusculas(jogos[i].cfg.description.c_str(), descricoesMinusculas[i]);
+            paraMinusculas(jogos[i].cfg.subject.c_str(), materiasMinusculas[i]);
+        }
+    }
+    textoAtual = texto;
+    materiaAtual = materia;
+    habilidadeAtual = habilidade;
+    jogosAtual = jogos.data();
+    quantidadeAtual = jogos.size();
+    valido = true;
+
+    resultado.clear();
+    paraMinusculas(texto, filtroMinusculo);
+    for (size_t i = 0; i < jogos.size(); ++i) {
+        const GameInfo& game = jogos[i];
+        bool filtroMateriaOk = (materia == "Todas") || (game.cfg.subject == materia);
+        bool filtroHabilidadeOk = (habilidade == "Todas") || (std::find(game.cfg.skills.begin(), game.cfg.skills.end(), habilidade) != game.cfg.skills.end());
+        bool filtroTextoOk = filtroMinusculo.empty() ||
+                             (descricoesMinusculas[i].find(filtroMinusculo) != std::string::npos) ||
+                             (materiasMinusculas[i].find(filtroMinusculo) != std::string::npos);
+        if (filtroMateriaOk && filtroHabilidadeOk && filtroTextoOk) resultado.push_back(i);
+    }
+    geracaoAtual++;
+    return true;
+}
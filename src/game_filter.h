@@ -0,0 +1,44 @@
+// game_filter.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "config_parser.h"
+
+// Critérios de filtro escolhidos na interface (ou por um roteiro de benchmark).
+struct EstadoFiltros {
+    char texto[128] = {0};
+    std::string materia = "Todas";
+    std::string habilidade = "Todas";
+};
+
+// Resultado do filtro de jogos (pesquisa, matéria e habilidade), recalculado
+// apenas quando algum critério muda. 'geracao' muda sempre que o conjunto
+// filtrado é recalculado, servindo de chave para etapas seguintes (layout).
+// As cópias em minúsculas dos textos dos jogos são feitas uma vez por
+// catálogo: recalcular ao digitar não aloca.
+class FiltroJogos {
+public:
+    // Retorna true se o resultado foi recalculado neste quadro.
+    bool atualizar(const std::vector<GameInfo>& jogos, const char* texto,
+                   const std::string& materia, const std::string& habilidade);
+    void invalidar() { valido = false; }
+
+    const std::vector<size_t>& indices() const { return resultado; }
+    uint64_t geracao() const { return geracaoAtual; }
+
+private:
+    std::string textoAtual;
+    std::string materiaAtual;
+    std::string habilidadeAtual;
+    const GameInfo* jogosAtual = nullptr;
+    size_t quantidadeAtual = 0;
+    bool valido = false;
+
+    std::vector<std::string> descricoesMinusculas;
+    std::vector<std::string> materiasMinusculas;
+    std::string filtroMinusculo;
+
+    std::vector<size_t> resultado;
+    uint64_t geracaoAtual = 0;
+};
@@ -0,0 +1,51 @@
+#include "glyph_ranges.h"
+
+namespace {
+
+// Área de uso privado do Unicode, onde o Font Awesome coloca os ícones.
+constexpr unsigned int PUA_INICIO = 0xE000;
+constexpr unsigned int PUA_FIM = 0xF8FF;
+
+// Acentos do português que o aluno pode digitar na pesquisa mesmo que o
+// catálogo atual não os use.
+const char* ACENTOS_PORTUGUES = u8"ÁÀÂÃÉÊÍÓÔÕÚÜÇáàâãéêíóôõúüç";
+
+bool ehIcone(unsigned int c) { return c >= PUA_INICIO && c <= PUA_FIM; }
+
+} // namespace
+
+void calcularFaixasGlifos(const std::vector<GameInfo>& jogos,
+                          const std::vector<const char*>& textosInterface,
+                          FaixasGlifos& saida) {
+    ImFontGlyphRangesBuilder usados;
+    for (ImWchar c = 0x20; c <= 0x7E; ++c) usados.AddChar(c);
+    usados.AddText(ACENTOS_PORTUGUES);
+
+    for (const auto& jogo : jogos) {
+        usados.AddText(jogo.cfg.subject.c_str());
+        usados.AddText(jogo.cfg.description.c_str());
+        for (const auto& skill : jogo.cfg.skills) usados.AddText(skill.c_str());
+    }
+    for (const char* texto : textosInterface) {
+        if (texto) usados.AddText(texto);
+    }
+
+    // Separa os codepoints: texto vai para o Roboto, ícones para o Font Awesome.
+    ImFontGlyphRangesBuilder texto, icones;
+    saida.totalTexto = 0;
+    saida.totalIcones = 0;
+    for (unsigned int c = 1; c <= 0xFFFF; ++c) {
+        if (!usados.GetBit(c)) continue;
+        if (ehIcone(c)) { icones.AddChar((ImWchar)c); saida.totalIcones++; }
+        else            { texto.AddChar((ImWchar)c);  saida.totalTexto++; }
+    }
+    texto.BuildRanges(&saida.texto);
+    icones.BuildRanges(&saida.icones);
+}
+
+void calcularFaixasTexto(const char* texto, ImVector<ImWchar>& saida) {
+    ImFontGlyphRangesBuilder builder;
+    builder.AddText(texto);
+    builder.AddChar((ImWchar)'?'); // Glifo de fallback usado pelo ImGui
+    builder.BuildRanges(&saida);
+}
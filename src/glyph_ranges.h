@@ -0,0 +1,24 @@
+// glyph_ranges.h
+#pragma once
+#include <vector>
+#include "imgui.h"
+#include "config_parser.h"
+
+// Faixas de glifos mínimas para o atlas de fontes, calculadas a partir do
+// catálogo carregado e dos textos fixos da interface.
+// Os vetores precisam continuar vivos até o atlas ser construído (ImFontAtlas::Build).
+struct FaixasGlifos {
+    ImVector<ImWchar> texto;   // ASCII imprimível + acentos do português + o que o catálogo usar
+    ImVector<ImWchar> icones;  // Somente os ícones Font Awesome referenciados (área de uso privado)
+    int totalTexto = 0;
+    int totalIcones = 0;
+};
+
+// Varre o texto do catálogo (matérias, habilidades, descrições) e os textos da
+// interface, separando os codepoints de texto dos ícones.
+void calcularFaixasGlifos(const std::vector<GameInfo>& jogos,
+                          const std::vector<const char*>& textosInterface,
+                          FaixasGlifos& saida);
+
+// Faixas apenas com os caracteres de um texto (ex.: a fonte grande do título).
+void calcularFaixasTexto(const char* texto, ImVector<ImWchar>& saida);
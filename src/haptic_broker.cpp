@@ -0,0 +1,234 @@
+#include "haptic_broker.h"
+#include "logger.h"
+#include "servo_loop.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace BrokerHaptico;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "A região compartilhada exige atômicos de 64 bits sem lock");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "A região compartilhada exige atômicos de 32 bits sem lock");
+
+namespace {
+
+Registro::Modulo g_log{"broker"};
+
+// Futex compartilhado entre processos (sem FUTEX_PRIVATE_FLAG)
+long futex(std::atomic<uint32_t>* endereco, int operacao, uint32_t valor, const timespec* timeout) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(endereco), operacao, valor, timeout, nullptr, 0);
+}
+
+Regiao* mapear(int fd) {
+    void* p = mmap(nullptr, sizeof(Regiao), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return p == MAP_FAILED ? nullptr : static_cast<Regiao*>(p);
+}
+
+bool processoVivo(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+// PID do launcher dono de uma região já existente, se ele ainda estiver vivo;
+// 0 se a região não existe ou ficou órfã.
+int32_t donoVivo(const char* nome) {
+    int fd = shm_open(nome, O_RDONLY, 0);
+    if (fd < 0) return 0;
+    int32_t pid = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Regiao)) {
+        void* p = mmap(nullptr, sizeof(Regiao), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            const Regiao* r = static_cast<const Regiao*>(p);
+            if (r->magica.load(std::memory_order_acquire) == MAGICA) pid = r->servidorPid.load(std::memory_order_relaxed);
+            munmap(p, sizeof(Regiao));
+        }
+    }
+    close(fd);
+    // O próprio PID só aparece numa sobra de outro namespace/boot: não temos região aberta
+    return pid != getpid() && processoVivo(pid) ? pid : 0;
+}
+
+} // namespace
+
+// --- Servidor (launcher) ---
+
+bool ServidorBroker::iniciar(GanchosServo& ganchos, const char* nome) {
+    if (regiao) return true;
+    if (int32_t dono = donoVivo(nome)) {
+        Registro::erro(g_log, "Broker háptico: {} pertence ao launcher {}, ainda em execução.", nome, dono);
+        errno = EEXIST;
+        return false;
+    }
+    shm_unlink(nome); // Região órfã de um launcher que não terminou direito
+    int fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        Registro::erro(g_log, "Broker háptico: shm_open({}) falhou: {}", nome, std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(Regiao)) != 0) {
+        Registro::erro(g_log, "Broker háptico: ftruncate falhou: {}", std::strerror(errno));
+        close(fd);
+        shm_unlink(nome);
+        return false;
+    }
+    Regiao* r = mapear(fd);
+    close(fd);
+    if (!r) {
+        Registro::erro(g_log, "Broker háptico: mmap falhou: {}", std::strerror(errno));
+        shm_unlink(nome);
+        return false;
+    }
+    mlock(r, sizeof(Regiao)); // Evita falta de página na thread servo; falhar aqui não é fatal
+
+    new (r) Regiao(); // Memória recém-truncada já é zero; inicializa os atômicos formalmente
+    r->versao = VERSAO;
+    r->tamanho = sizeof(Regiao);
+    r->servidorPid.store(getpid(), std::memory_order_relaxed);
+    r->magica.store(MAGICA, std::memory_order_release);
+
+    regiao = r;
+    nomeRegiao = nome;
+    ganchosServo = &ganchos;
+    ganchos.definirFonteForca(&ServidorBroker::forcaCliente, this);
+    if (!ganchos.adicionarObservador(&ServidorBroker::aoAmostrar, this)) {
+        Registro::erro(g_log, "Broker háptico: sem slot livre para observar o laço servo.");
+        parar();
+        return false;
+    }
+    setenv(VARIAVEL_AMBIENTE, nome, 1); // Herdado pelos jogos lançados
+    Registro::info(g_log, "Broker háptico ativo em {} ({} bytes).", nome, sizeof(Regiao));
+    return true;
+}
+
+void ServidorBroker::parar() {
+    if (!regiao) return;
+    if (ganchosServo) {
+        ganchosServo->removerObservador(&ServidorBroker::aoAmostrar);
+        ganchosServo->definirFonteForca(nullptr, nullptr);
+        // Se o servo ainda roda, espera ele sair dos ganchos antes de desmapear
+        ganchosServo->aguardarQuiescencia();
+        ganchosServo = nullptr;
+    }
+    regiao->servidorPid.store(0, std::memory_order_release);
+    regiao->magica.store(0, std::memory_order_release);
+    regiao->campainha.fetch_add(1);
+    futex(&regiao->campainha, FUTEX_WAKE, INT_MAX, nullptr); // Acorda clientes para perceberem o fim
+    munmap(regiao, sizeof(Regiao));
+    shm_unlink(nomeRegiao.c_str());
+    unsetenv(VARIAVEL_AMBIENTE);
+    regiao = nullptr;
+}
+
+bool ServidorBroker::clienteConectado() const {
+    return regiao && regiao->clientePid.load(std::memory_order_relaxed) != 0;
+}
+
+void ServidorBroker::aoAmostrar(void* contexto, const HapticSample& amostra) {
+    Regiao* r = static_cast<ServidorBroker*>(contexto)->regiao;
+    r->anel[amostra.tick % ANEL].publicar(amostra);
+    r->ultimoTick.store(amostra.tick, std::memory_order_release);
+    r->amostras.store(r->amostras.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    r->campainha.fetch_add(1);
+    if (r->esperando.load() != 0) futex(&r->campainha, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+bool ServidorBroker::forcaCliente(void* contexto, uint64_t agoraNs, HapticVec3& forca) {
+    auto* self = static_cast<ServidorBroker*>(contexto);
+    Regiao* r = self->regiao;
+    if (r->clientePid.load(std::memory_order_relaxed) == 0) return false;
+    ComandoForca c;
+    if (!r->comando.ler(c) || c.sequencia == 0) return false;
+    if (c.timestampNs + PRAZO_COMANDO_NS < agoraNs) return false; // Cliente parou de comandar
+    forca = c.forca;
+    self->aplicados.store(self->aplicados.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+// --- Cliente (jogo) ---
+
+bool ClienteBroker::conectar(const char* nome) {
+    if (regiao) return true;
+    if (!nome) nome = getenv(VARIAVEL_AMBIENTE);
+    if (!nome) nome = NOME_PADRAO;
+
+    int fd = shm_open(nome, O_RDWR, 0);
+    if (fd < 0) return false; // Launcher não está rodando com broker
+    Regiao* r = mapear(fd);
+    close(fd);
+    if (!r) return false;
+    if (r->magica.load(std::memory_order_acquire) != MAGICA || r->versao != VERSAO || r->tamanho != sizeof(Regiao)) {
+        Registro::erro(g_log, "Broker háptico: região incompatível em {}", nome);
+        munmap(r, sizeof(Regiao));
+        return false;
+    }
+
+    // Um cliente por vez; assume o lugar de um cliente que morreu sem desconectar
+    const int32_t pid = getpid();
+    int32_t atual = 0;
+    if (!r->clientePid.compare_exchange_strong(atual, pid)) {
+        if (processoVivo(atual) || !r->clientePid.compare_exchange_strong(atual, pid)) {
+            Registro::aviso(g_log, "Broker háptico: dispositivo em uso pelo processo {}", atual);
+            munmap(r, sizeof(Regiao));
+            return false;
+        }
+    }
+    regiao = r;
+    amostrasVistas = r->amostras.load(std::memory_order_acquire);
+    return true;
+}
+
+void ClienteBroker::desconectar() {
+    if (!regiao) return;
+    enviarForca(HapticVec3{});
+    int32_t pid = getpid();
+    regiao->clientePid.compare_exchange_strong(pid, 0);
+    munmap(regiao, sizeof(Regiao));
+    regiao = nullptr;
+}
+
+bool ClienteBroker::lerEstado(HapticSample& amostra) const {
+    if (!regiao || regiao->servidorPid.load(std::memory_order_acquire) == 0) return false;
+    if (regiao->amostras.load(std::memory_order_acquire) == 0) return false;
+    uint64_t t = regiao->ultimoTick.load(std::memory_order_acquire);
+    return regiao->anel[t % ANEL].ler(amostra);
+}
+
+bool ClienteBroker::aguardarAmostra(HapticSample& amostra, int timeoutMs) {
+    if (!regiao) return false;
+    const uint64_t limite = relogioMonotonicoNs() + (uint64_t)timeoutMs * 1000000ull;
+    while (true) {
+        const uint32_t campainha = regiao->campainha.load();
+        const uint64_t total = regiao->amostras.load(std::memory_order_acquire);
+        if (regiao->servidorPid.load(std::memory_order_acquire) == 0) return false;
+        if (total != amostrasVistas && lerEstado(amostra)) {
+            amostrasVistas = total;
+            return true;
+        }
+        const uint64_t agora = relogioMonotonicoNs();
+        if (agora >= limite) return false;
+        const uint64_t restante = limite - agora;
+        timespec ts{ (time_t)(restante / 1000000000ull), (long)(restante % 1000000000ull) };
+        regiao->esperando.fetch_add(1);
+        futex(&regiao->campainha, FUTEX_WAIT, campainha, &ts); // Volta na hora se a campainha já mudou
+        regiao->esperando.fetch_sub(1);
+    }
+}
+
+void ClienteBroker::enviarForca(const HapticVec3& forca) {
+    if (!regiao) return;
+    ComandoForca c;
+    c.timestampNs = relogioMonotonicoNs();
+    c.sequencia = ++sequencia;
+    c.forca = forca;
+    regiao->comando.publicar(c);
+}
@@ -0,0 +1,97 @@
+// haptic_broker.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include "haptic_types.h"
+#include "servo_hooks.h"
+#include "state_channel.h"
+
+// Broker háptico em memória compartilhada.
+//
+// O launcher abre o dispositivo uma única vez e mantém o laço servo rodando;
+// a cada iteração ele publica a amostra numa região POSIX (shm_open) e lê o
+// último comando de força do cliente. Os jogos lançados se conectam como
+// clientes (ClienteBroker) em vez de abrir o dispositivo, então a troca de
+// atividade não paga enumeração USB, abertura nem calibração.
+//
+// - Estado: anel de ANEL amostras, cada uma num seqlock (CanalEstado); o
+//   servo nunca espera pelos clientes.
+// - Campainha: palavra futex incrementada a cada amostra. Clientes que querem
+//   dormir até a próxima amostra fazem FUTEX_WAIT; o servo só faz FUTEX_WAKE
+//   quando há alguém esperando, então sem clientes não há chamada de sistema.
+// - Força: último comando do cliente (seqlock). Comandos mais velhos que
+//   PRAZO_COMANDO_NS são ignorados, então um jogo que trava ou morre não deixa
+//   força aplicada no dispositivo.
+namespace BrokerHaptico {
+    constexpr const char* NOME_PADRAO = "/jardim-haptico";
+    constexpr const char* VARIAVEL_AMBIENTE = "JARDIM_HAPTIC_BROKER"; // Nome da região, exportado para os jogos
+    constexpr uint32_t MAGICA = 0x4A485442; // "JHTB"
+    constexpr uint32_t VERSAO = 1;
+    constexpr int ANEL = 64;
+    constexpr uint64_t PRAZO_COMANDO_NS = 50000000ull; // 50 ms
+
+    struct ComandoForca {
+        uint64_t timestampNs = 0; // CLOCK_MONOTONIC do cliente (mesmo relógio do servo)
+        uint64_t sequencia = 0;
+        HapticVec3 forca;
+    };
+
+    struct Regiao {
+        std::atomic<uint32_t> magica;
+        uint32_t versao;
+        uint32_t tamanho;
+        std::atomic<int32_t> servidorPid;
+        std::atomic<int32_t> clientePid;      // 0 = livre; um cliente por vez
+        alignas(64) std::atomic<uint32_t> campainha;
+        std::atomic<uint32_t> esperando;      // Clientes dentro de FUTEX_WAIT
+        alignas(64) std::atomic<uint64_t> ultimoTick;
+        std::atomic<uint64_t> amostras;       // Total publicado
+        CanalEstado<HapticSample> anel[ANEL];
+        CanalEstado<ComandoForca> comando;
+    };
+}
+
+// Lado do launcher: cria a região e se registra nos ganchos do servo.
+class ServidorBroker {
+public:
+    ~ServidorBroker() { parar(); }
+
+    bool iniciar(GanchosServo& ganchos, const char* nome = BrokerHaptico::NOME_PADRAO);
+    void parar();
+
+    bool ativo() const { return regiao != nullptr; }
+    bool clienteConectado() const;
+    uint64_t comandosAplicados() const { return aplicados.load(std::memory_order_relaxed); }
+
+private:
+    static void aoAmostrar(void* contexto, const HapticSample& amostra);
+    static bool forcaCliente(void* contexto, uint64_t agoraNs, HapticVec3& forca);
+
+    BrokerHaptico::Regiao* regiao = nullptr;
+    GanchosServo* ganchosServo = nullptr;
+    std::string nomeRegiao;
+    std::atomic<uint64_t> aplicados{0};
+};
+
+// Lado do jogo: conecta à região do launcher.
+class ClienteBroker {
+public:
+    ~ClienteBroker() { desconectar(); }
+
+    // nome nulo: usa $JARDIM_HAPTIC_BROKER ou o nome padrão.
+    bool conectar(const char* nome = nullptr);
+    void desconectar();
+    bool conectado() const { return regiao != nullptr; }
+
+    bool lerEstado(HapticSample& amostra) const;
+    // Dorme até haver amostra mais nova que a última lida (ou timeout). Retorna false no timeout.
+    bool aguardarAmostra(HapticSample& amostra, int timeoutMs);
+    void enviarForca(const HapticVec3& forca);
+
+private:
+    BrokerHaptico::Regiao* regiao = nullptr;
+    uint64_t amostrasVistas = 0;
+    uint64_t sequencia = 0;
+};
@@ -0,0 +1,189 @@
+#include "haptic_recording.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include "servo_loop.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace GravacaoHaptica;
+
+namespace {
+
+Registro::Modulo g_log{"gravacao"};
+
+constexpr auto INTERVALO_ESCRITA = std::chrono::milliseconds(20);
+
+bool escreverTudo(int fd, const void* dados, size_t tamanho) {
+    const char* p = static_cast<const char*>(dados);
+    while (tamanho > 0) {
+        ssize_t n = write(fd, p, tamanho);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        tamanho -= (size_t)n;
+    }
+    return true;
+}
+
+} // namespace
+
+RegistroGravado GravacaoHaptica::compactar(const HapticSample& s) {
+    RegistroGravado r;
+    r.timestampNs = s.timestampNs;
+    r.posicao[0] = (float)s.position.x; r.posicao[1] = (float)s.position.y; r.posicao[2] = (float)s.position.z;
+    r.velocidade[0] = (float)s.velocity.x; r.velocidade[1] = (float)s.velocity.y; r.velocidade[2] = (float)s.velocity.z;
+    for (int i = 0; i < 9; ++i) r.rotacao[i] = (float)s.rotation.m[i];
+    r.forca[0] = (float)s.force.x; r.forca[1] = (float)s.force.y; r.forca[2] = (float)s.force.z;
+    r.botoes = s.buttons;
+    return r;
+}
+
+HapticSample GravacaoHaptica::expandir(const RegistroGravado& r, uint64_t tick) {
+    HapticSample s;
+    s.timestampNs = r.timestampNs;
+    s.tick = tick;
+    s.position = HapticVec3{ r.posicao[0], r.posicao[1], r.posicao[2] };
+    s.velocity = HapticVec3{ r.velocidade[0], r.velocidade[1], r.velocidade[2] };
+    for (int i = 0; i < 9; ++i) s.rotation.m[i] = r.rotacao[i];
+    s.force = HapticVec3{ r.forca[0], r.forca[1], r.forca[2] };
+    s.buttons = r.botoes;
+    return s;
+}
+
+bool GravacaoHaptica::carregar(const std::string& caminho, std::vector<HapticSample>& amostras, double& taxaHz) {
+    std::ifstream arquivo(caminho, std::ios::binary);
+    if (!arquivo.is_open()) {
+        Registro::erro(g_log, "Erro ao abrir gravação háptica: {}", caminho);
+        return false;
+    }
+    CabecalhoGravacao cab;
+    if (!arquivo.read(reinterpret_cast<char*>(&cab), sizeof(cab)) || std::memcmp(cab.magica, MAGICA, sizeof(MAGICA)) != 0 ||
+        cab.versao != VERSAO || cab.tamanhoRegistro != sizeof(RegistroGravado) || !(cab.taxaHz > 0.0)) {
+        Registro::erro(g_log, "Gravação háptica inválida ou de versão incompatível: {}", caminho);
+        return false;
+    }
+
+    arquivo.seekg(0, std::ios::end);
+    const std::streamoff tamanho = arquivo.tellg() - (std::streamoff)sizeof(cab);
+    arquivo.seekg(sizeof(cab), std::ios::beg);
+    std::vector<RegistroGravado> registros((size_t)tamanho / sizeof(RegistroGravado)); // Registro final truncado é ignorado
+    arquivo.read(reinterpret_cast<char*>(registros.data()), registros.size() * sizeof(RegistroGravado));
+
+    amostras.clear();
+    amostras.reserve(registros.size());
+    for (size_t i = 0; i < registros.size(); ++i) amostras.push_back(expandir(registros[i], i));
+    taxaHz = cab.taxaHz;
+    Registro::info(g_log, "Gravação háptica carregada: {} amostras a {} Hz ({} s)", amostras.size(), taxaHz,
+                   amostras.size() / taxaHz);
+    return !amostras.empty();
+}
+
+bool GravadorHaptico::iniciar(const std::string& caminho, double taxaHz, GanchosServo& ganchos) {
+    if (rodando.load()) return true;
+    fd = open(caminho.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Registro::erro(g_log, "Erro ao criar gravação háptica {}: {}", caminho, std::strerror(errno));
+        return false;
+    }
+    CabecalhoGravacao cab;
+    std::memcpy(cab.magica, MAGICA, sizeof(MAGICA));
+    cab.versao = VERSAO;
+    cab.tamanhoRegistro = sizeof(RegistroGravado);
+    cab.taxaHz = taxaHz;
+    cab.inicioNs = relogioMonotonicoNs();
+    if (!escreverTudo(fd, &cab, sizeof(cab))) {
+        Registro::erro(g_log, "Erro ao escrever gravação háptica: {}", std::strerror(errno));
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    anel.assign(CAPACIDADE, RegistroGravado{});
+    cabeca.store(0);
+    cauda.store(0);
+    perdidos.store(0);
+    escritos.store(0);
+    caminhoArquivo = caminho;
+    rodando.store(true);
+    thread = std::thread(&GravadorHaptico::executarEscrita, this);
+
+    ganchosServo = &ganchos;
+    if (!ganchos.adicionarObservador(&GravadorHaptico::aoAmostrar, this)) {
+        Registro::erro(g_log, "Gravação háptica: sem slot livre para observar o laço servo.");
+        parar();
+        return false;
+    }
+    Registro::info(g_log, "Gravando fluxo háptico em {}", caminho);
+    return true;
+}
+
+void GravadorHaptico::parar() {
+    if (!rodando.load()) return;
+    if (ganchosServo) {
+        ganchosServo->removerObservador(&GravadorHaptico::aoAmostrar);
+        ganchosServo->aguardarQuiescencia(); // A thread servo não escreve mais no anel
+        ganchosServo = nullptr;
+    }
+    rodando.store(false);
+    if (thread.joinable()) thread.join();
+    close(fd);
+    fd = -1;
+    if (descartados())
+        Registro::aviso(g_log, "Gravação háptica encerrada: {} amostras em {} ({} descartadas)", gravados(), caminhoArquivo, descartados());
+    else
+        Registro::info(g_log, "Gravação háptica encerrada: {} amostras em {}", gravados(), caminhoArquivo);
+}
+
+void GravadorHaptico::aoAmostrar(void* contexto, const HapticSample& amostra) {
+    auto* self = static_cast<GravadorHaptico*>(contexto);
+    const uint64_t c = self->cabeca.load(std::memory_order_relaxed);
+    if (c - self->cauda.load(std::memory_order_acquire) >= CAPACIDADE) {
+        self->perdidos.store(self->perdidos.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    self->anel[c & (CAPACIDADE - 1)] = compactar(amostra);
+    self->cabeca.store(c + 1, std::memory_order_release);
+}
+
+bool GravadorHaptico::esvaziar() {
+    uint64_t t = cauda.load(std::memory_order_relaxed);
+    const uint64_t c = cabeca.load(std::memory_order_acquire);
+    while (t < c) {
+        // Trecho contíguo até o fim do anel ou até a cabeça
+        const size_t inicio = (size_t)(t & (CAPACIDADE - 1));
+        const size_t n = (size_t)std::min<uint64_t>(c - t, CAPACIDADE - inicio);
+        if (!escreverTudo(fd, &anel[inicio], n * sizeof(RegistroGravado))) {
+            Registro::erro(g_log, "Erro ao escrever gravação háptica: {}", std::strerror(errno));
+            return false;
+        }
+        t += n;
+        cauda.store(t, std::memory_order_release);
+        escritos.store(escritos.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void GravadorHaptico::executarEscrita() {
+    pthread_setname_np(pthread_self(), "haptic-rec");
+    ParadaEmergencia::prepararThread();
+    bool ok = true;
+    while (rodando.load() && ok) {
+        std::this_thread::sleep_for(INTERVALO_ESCRITA);
+        ok = esvaziar();
+    }
+    if (ok) esvaziar(); // O que sobrou após a remoção do observador
+}
+
+void lerOpcoesGravacao(int argc, char** argv, std::string& caminho) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--record-haptics") == 0 && i + 1 < argc) caminho = argv[++i];
+    }
+}
@@ -0,0 +1,83 @@
+// haptic_recording.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "haptic_types.h"
+#include "servo_hooks.h"
+
+// Gravação binária do fluxo do laço servo, para reproduzir a mesma sessão no
+// simulador (HapticSimulator::Config::gravacao) sem hardware.
+//
+// Formato (little-endian, append-only): CabecalhoGravacao seguido de um
+// RegistroGravado por iteração do servo. Posição, velocidade, rotação e força
+// vão em float (resolução de µm/mN na faixa do dispositivo), metade do tamanho
+// de HapticSample.
+namespace GravacaoHaptica {
+    constexpr char MAGICA[8] = { 'J', 'H', 'R', 'E', 'C', '1', 0, 0 };
+    constexpr uint32_t VERSAO = 1;
+
+#pragma pack(push, 1)
+    struct CabecalhoGravacao {
+        char magica[8];
+        uint32_t versao;
+        uint32_t tamanhoRegistro;
+        double taxaHz;
+        uint64_t inicioNs;      // CLOCK_MONOTONIC da primeira amostra esperada
+    };
+
+    struct RegistroGravado {
+        uint64_t timestampNs;
+        float posicao[3];
+        float velocidade[3];
+        float rotacao[9];
+        float forca[3];          // Força comandada naquela iteração
+        uint32_t botoes;
+    };
+#pragma pack(pop)
+
+    RegistroGravado compactar(const HapticSample& amostra);
+    HapticSample expandir(const RegistroGravado& registro, uint64_t tick);
+
+    // Lê uma gravação inteira. taxaHz recebe a taxa do servo na gravação.
+    bool carregar(const std::string& caminho, std::vector<HapticSample>& amostras, double& taxaHz);
+}
+
+// Grava as amostras do servo via GanchosServo. A thread servo só copia o
+// registro para um anel pré-alocado (sem alocação nem syscall); uma thread de
+// escrita esvazia o anel no arquivo. Se o disco não acompanhar, registros são
+// descartados e contados em vez de atrasar o servo.
+class GravadorHaptico {
+public:
+    static constexpr size_t CAPACIDADE = 8192; // ~8 s a 1 kHz; potência de dois
+
+    ~GravadorHaptico() { parar(); }
+
+    bool iniciar(const std::string& caminho, double taxaHz, GanchosServo& ganchos);
+    void parar();
+
+    bool ativo() const { return rodando.load(std::memory_order_relaxed); }
+    uint64_t gravados() const { return escritos.load(std::memory_order_relaxed); }
+    uint64_t descartados() const { return perdidos.load(std::memory_order_relaxed); }
+
+private:
+    static void aoAmostrar(void* contexto, const HapticSample& amostra);
+    void executarEscrita();
+    bool esvaziar();
+
+    std::vector<GravacaoHaptica::RegistroGravado> anel; // Pré-alocado em iniciar
+    alignas(64) std::atomic<uint64_t> cabeca{0};         // Escrito pela thread servo
+    alignas(64) std::atomic<uint64_t> cauda{0};          // Escrito pela thread de escrita
+    std::atomic<uint64_t> perdidos{0};
+    std::atomic<uint64_t> escritos{0};
+    std::atomic<bool> rodando{false};
+    std::thread thread;
+    GanchosServo* ganchosServo = nullptr;
+    int fd = -1;
+    std::string caminhoArquivo;
+};
+
+// Lê --record-haptics ARQUIVO.
+void lerOpcoesGravacao(int argc, char** argv, std::string& caminho);
@@ -1,5 +1,256 @@
 #include "haptic_simulator.h"
+#include "emergency_stop.h"
+#include "haptic_recording.h"
+#include "logger.h"
+#include "servo_loop.h"
+#include "state_channel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
 
-void initHapticSimulation() {
-    std::cout << "Simulação háptica inicializada\n";
+namespace {
+
+Registro::Modulo g_log{"simulacao"};
+
+constexpr double PI = 3.14159265358979323846;
+
+// O efetuador simulado responde à força comandada como massa-mola-amortecedor
+// somado à trajetória roteirizada (ou gravada).
+constexpr double MASSA = 0.2;          // kg
+constexpr double RIGIDEZ = 200.0;      // N/m
+constexpr double AMORTECIMENTO = 5.0;  // N·s/m
+
+struct EstadoSimulador {
+    HapticSimulator::Config config;
+    LacoServo servo;
+
+    CanalEstado<HapticSample> estado;  // Publicado pela thread servo a cada iteração
+    CanalEstado<HapticVec3> forca;     // Publicado por quem chama setForce
+    GanchosServo ganchos;              // Broker, gravador
+
+    // Estado da dinâmica; só a thread servo acessa
+    HapticVec3 deslocamento;
+    HapticVec3 velocidadeDeslocamento;
+    size_t indiceGravacao = 0;         // Cursor da reprodução
+};
+
+EstadoSimulador g_sim;
+
+const char* nomeTrajetoria(HapticSimulator::Trajetoria t) {
+    switch (t) {
+    case HapticSimulator::Trajetoria::Parado: return "parado";
+    case HapticSimulator::Trajetoria::Circulo: return "circulo";
+    case HapticSimulator::Trajetoria::Oito: return "oito";
+    }
+    return "?";
+}
+
+void trajetoriaRoteirizada(const HapticSimulator::Config& c, double t, HapticSample& s) {
+    const double w = 2.0 * PI / c.periodoS;
+    const double a = c.amplitude;
+    switch (c.trajetoria) {
+    case HapticSimulator::Trajetoria::Parado:
+        s.position = HapticVec3{};
+        s.velocity = HapticVec3{};
+        break;
+    case HapticSimulator::Trajetoria::Circulo:
+        s.position = HapticVec3{ a * std::cos(w * t), a * std::sin(w * t), 0.0 };
+        s.velocity = HapticVec3{ -a * w * std::sin(w * t), a * w * std::cos(w * t), 0.0 };
+        break;
+    case HapticSimulator::Trajetoria::Oito:
+        s.position = HapticVec3{ a * std::sin(w * t), 0.5 * a * std::sin(2.0 * w * t), 0.0 };
+        s.velocity = HapticVec3{ a * w * std::cos(w * t), a * w * std::cos(2.0 * w * t), 0.0 };
+        break;
+    }
+    s.rotation = HapticMat3{};
+    // Botão 0 pressionado durante o primeiro meio segundo de cada volta
+    s.buttons = (std::fmod(t, c.periodoS) < 0.5) ? 1u : 0u;
+}
+
+// Amostra gravada para a iteração 'tick'. O tempo da reprodução avança
+// velocidadeGravacao / taxaHz por iteração; vale a última amostra cujo
+// timestamp (relativo à primeira) já passou.
+const HapticSample& amostraGravada(const HapticSimulator::Config& c, uint64_t tick) {
+    const std::vector<HapticSample>& g = c.gravacao;
+    const uint64_t inicioNs = g.front().timestampNs;
+    uint64_t t = (uint64_t)((double)tick * 1.0e9 * c.velocidadeGravacao / c.taxaHz);
+    if (c.repetirGravacao) {
+        // Uma volta dura a gravação mais um período nominal, até a primeira amostra de novo
+        const uint64_t periodoNs = (uint64_t)(1.0e9 * c.velocidadeGravacao / c.taxaHz);
+        t %= g.back().timestampNs - inicioNs + std::max<uint64_t>(periodoNs, 1);
+    }
+    size_t& i = g_sim.indiceGravacao;
+    if (i >= g.size() || g[i].timestampNs - inicioNs > t) i = 0; // Nova volta
+    while (i + 1 < g.size() && g[i + 1].timestampNs - inicioNs <= t) ++i;
+    return g[i];
+}
+
+void iteracao(uint64_t tick, uint64_t inicioNs) {
+    const HapticSimulator::Config& c = g_sim.config;
+    const double dt = 1.0 / c.taxaHz;
+
+    HapticVec3 forca;
+    // Parada de emergência anula tudo; depois, comando de um cliente do broker tem
+    // prioridade; sem comando publicado: força zero
+    const bool parada = ParadaEmergencia::ativa();
+    if (!parada && !g_sim.ganchos.forcaExterna(inicioNs, forca)) g_sim.forca.ler(forca);
+    if (parada) ParadaEmergencia::confirmarForcaZero();
+
+    HapticSample s;
+    if (!c.gravacao.empty()) {
+        s = amostraGravada(c, tick);
+    } else {
+        trajetoriaRoteirizada(c, (double)tick * dt, s);
+    }
+
+    // Integração semi-implícita de Euler da resposta à força
+    HapticVec3& d = g_sim.deslocamento;
+    HapticVec3& v = g_sim.velocidadeDeslocamento;
+    v.x += dt * (forca.x - RIGIDEZ * d.x - AMORTECIMENTO * v.x) / MASSA;
+    v.y += dt * (forca.y - RIGIDEZ * d.y - AMORTECIMENTO * v.y) / MASSA;
+    v.z += dt * (forca.z - RIGIDEZ * d.z - AMORTECIMENTO * v.z) / MASSA;
+    d.x += dt * v.x; d.y += dt * v.y; d.z += dt * v.z;
+
+    s.position.x += d.x; s.position.y += d.y; s.position.z += d.z;
+    s.velocity.x += v.x; s.velocity.y += v.y; s.velocity.z += v.z;
+    s.force = forca;
+    s.tick = tick;
+    s.timestampNs = inicioNs;
+
+    g_sim.estado.publicar(s);
+    g_sim.ganchos.notificar(s);
+}
+
+} // namespace
+
+bool HapticSimulator::init() {
+    return init(Config());
+}
+
+bool HapticSimulator::init(const Config& config) {
+    if (g_sim.servo.rodando()) return true;
+    if (!(config.periodoS > 0.0)) {
+        Registro::erro(g_log, "Simulação háptica: período de trajetória inválido ({} s)", config.periodoS);
+        return false;
+    }
+    g_sim.config = config;
+    g_sim.forca.publicar(HapticVec3{});
+    g_sim.deslocamento = HapticVec3{};
+    g_sim.velocidadeDeslocamento = HapticVec3{};
+    g_sim.indiceGravacao = 0;
+    OpcoesServo opcoes;
+    opcoes.tempoReal = config.tempoReal;
+    if (!g_sim.servo.iniciar("haptic-sim", config.taxaHz, iteracao, opcoes)) return false;
+    Registro::info(g_log, "Simulação háptica inicializada ({} Hz, fonte: {})", config.taxaHz,
+                   config.gravacao.empty() ? nomeTrajetoria(config.trajetoria) : "gravação");
+    return true;
+}
+
+void HapticSimulator::shutdown() {
+    if (!g_sim.servo.rodando()) return;
+    g_sim.servo.parar();
+    Registro::info(g_log, "Simulação háptica finalizada ({} iterações)", g_sim.servo.ticks());
+}
+
+bool HapticSimulator::isRunning() {
+    return g_sim.servo.rodando();
+}
+
+bool HapticSimulator::readState(HapticSample& amostra) {
+    return g_sim.estado.ler(amostra);
+}
+
+bool HapticSimulator::getPosition(HapticVec3& posicao) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    posicao = s.position;
+    return true;
+}
+
+bool HapticSimulator::getLinearVelocity(HapticVec3& velocidade) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    velocidade = s.velocity;
+    return true;
+}
+
+bool HapticSimulator::getRotation(HapticMat3& rotacao) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    rotacao = s.rotation;
+    return true;
+}
+
+bool HapticSimulator::getUserSwitches(uint32_t& botoes) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    botoes = s.buttons;
+    return true;
+}
+
+bool HapticSimulator::setForce(const HapticVec3& forca) {
+    if (!isRunning()) return false;
+    g_sim.forca.publicar(forca);
+    return true;
+}
+
+uint64_t HapticSimulator::ticks() {
+    return g_sim.servo.ticks();
+}
+
+const EstatisticasServo& HapticSimulator::servoStats() {
+    return g_sim.servo.estatisticas();
+}
+
+GanchosServo& HapticSimulator::servoHooks() {
+    return g_sim.ganchos;
+}
+
+bool lerOpcoesSimulador(int argc, char** argv, HapticSimulator::Config& config) {
+    std::string reproducao;
+    double velocidade = 1.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--sim-rate" && i + 1 < argc) {
+            char* fim = nullptr;
+            double taxa = std::strtod(argv[++i], &fim);
+            if (!fim || *fim != '\0' || !(taxa > 0.0) || taxa > 20000.0) {
+                std::cerr << "Valor inválido para --sim-rate: " << argv[i] << std::endl;
+                return false;
+            }
+            config.taxaHz = taxa;
+        } else if (arg == "--sim-trajectory" && i + 1 < argc) {
+            std::string nome = argv[++i];
+            if (nome == "parado") config.trajetoria = HapticSimulator::Trajetoria::Parado;
+            else if (nome == "circulo") config.trajetoria = HapticSimulator::Trajetoria::Circulo;
+            else if (nome == "oito") config.trajetoria = HapticSimulator::Trajetoria::Oito;
+            else { std::cerr << "Trajetória desconhecida para --sim-trajectory: " << nome << std::endl; return false; }
+        } else if (arg == "--sim-replay" && i + 1 < argc) {
+            reproducao = argv[++i];
+        } else if (arg == "--sim-replay-speed" && i + 1 < argc) {
+            char* fim = nullptr;
+            velocidade = std::strtod(argv[++i], &fim);
+            if (!fim || *fim != '\0' || !(velocidade > 0.0)) {
+                std::cerr << "Valor inválido para --sim-replay-speed: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--sim-replay-once") {
+            config.repetirGravacao = false;
+        }
+    }
+    if (!reproducao.empty()) {
+        // Servo na taxa da gravação × fator, perto de uma amostra por iteração; o ritmo
+        // vem dos timestamps gravados (amostraGravada)
+        double taxaGravacao = 0.0;
+        if (!GravacaoHaptica::carregar(reproducao, config.gravacao, taxaGravacao)) return false;
+        config.taxaHz = taxaGravacao * velocidade;
+        config.velocidadeGravacao = velocidade;
+        if (config.taxaHz > 20000.0) {
+            std::cerr << "Reprodução acelerada demais: " << config.taxaHz << " Hz (máximo 20000)" << std::endl;
+            return false;
+        }
+    }
+    return true;
 }
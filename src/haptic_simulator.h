@@ -1,13 +1,60 @@
+// haptic_simulator.h
 #pragma once
-#include <iostream>
+#include <cstdint>
+#include <vector>
+#include "haptic_types.h"
+#include "servo_hooks.h"
+#include "servo_stats.h"
 
+// Dispositivo háptico simulado, para builds com DISABLE_HAPTICS.
+// Roda um laço servo determinístico numa thread própria (1 kHz por padrão):
+// a trajetória depende só do número da iteração, nunca do relógio, então duas
+// execuções com a mesma configuração produzem exatamente as mesmas amostras.
+// A API de leitura/escrita é a mesma de Haptics (haptics.h).
 class HapticSimulator {  // Alterado para class ao invés de struct
 public:
-    static void init() {
-        std::cout << "Simulação háptica inicializada\n";
-    }
-    
-    static void shutdown() {
-        std::cout << "Simulação háptica finalizada\n";
-    }
+    enum class Trajetoria { Parado, Circulo, Oito };
+
+    struct Config {
+        double taxaHz = 1000.0;                    // Frequência do laço servo
+        Trajetoria trajetoria = Trajetoria::Circulo;
+        double amplitude = 0.03;                   // m
+        double periodoS = 4.0;                     // Duração de uma volta da trajetória
+        // Fonte gravada: se não estiver vazia, as amostras são reproduzidas no
+        // lugar da trajetória roteirizada, no ritmo dos timestamps gravados
+        // (lacunas e jitter incluídos) multiplicado por velocidadeGravacao. O
+        // relógio da reprodução é o número da iteração: continua determinística.
+        std::vector<HapticSample> gravacao;
+        double velocidadeGravacao = 1.0;
+        bool repetirGravacao = true;
+        bool tempoReal = false;                    // Modo de realtime.h para a thread servo
+    };
+
+    static bool init();  // Configuração padrão
+    static bool init(const Config& config);
+    static void shutdown();
+    static bool isRunning();
+
+    // Última amostra publicada pela thread servo. Sem locks; pode ser chamada de
+    // qualquer thread (UI, loggers) a qualquer frequência.
+    static bool readState(HapticSample& amostra);
+
+    // Mesma API do dispositivo real. setForce deve ser chamada por uma única thread.
+    static bool getPosition(HapticVec3& posicao);
+    static bool getLinearVelocity(HapticVec3& velocidade);
+    static bool getRotation(HapticMat3& rotacao);
+    static bool getUserSwitches(uint32_t& botoes);
+    static bool setForce(const HapticVec3& forca);
+
+    static uint64_t ticks();
+    // Jitter e prazos perdidos do laço servo (leitura sem locks).
+    static const EstatisticasServo& servoStats();
+    // Observadores de amostras e fonte de força externa da thread servo.
+    static GanchosServo& servoHooks();
 };
+
+// Lê --sim-rate HZ, --sim-trajectory parado|circulo|oito e a reprodução de uma gravação
+// (--sim-replay ARQUIVO, --sim-replay-speed FATOR, --sim-replay-once). O servo roda na
+// taxa da gravação multiplicada pelo fator; o ritmo das amostras segue os timestamps
+// gravados. Retorna false se algum valor for inválido.
+bool lerOpcoesSimulador(int argc, char** argv, HapticSimulator::Config& config);
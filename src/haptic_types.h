@@ -0,0 +1,28 @@
+// haptic_types.h
+#pragma once
+#include <cstdint>
+
+// Tipos compartilhados entre o dispositivo real (haptics.h) e o simulado
+// (haptic_simulator.h), sem depender do CHAI3D.
+
+struct HapticVec3 {
+    double x = 0.0, y = 0.0, z = 0.0;
+};
+
+// Matriz de rotação 3x3 em ordem de linhas.
+struct HapticMat3 {
+    double m[9] = { 1.0, 0.0, 0.0,
+                    0.0, 1.0, 0.0,
+                    0.0, 0.0, 1.0 };
+};
+
+// Uma amostra do laço servo.
+struct HapticSample {
+    uint64_t timestampNs = 0; // CLOCK_MONOTONIC
+    uint64_t tick = 0;        // Iteração do laço servo
+    HapticVec3 position;      // m
+    HapticVec3 velocity;      // m/s
+    HapticMat3 rotation;
+    uint32_t buttons = 0;     // Bit i = botão i pressionado
+    HapticVec3 force;         // Força comandada aplicada nesta iteração (N)
+};
@@ -1,15 +1,221 @@
 #include "haptics.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include "servo_hooks.h"
+#include "servo_loop.h"
+#include "state_channel.h"
+#include <algorithm>
+#include <atomic>
 #include <chai3d.h>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <thread>
 
 using namespace chai3d;
 
-cGenericHapticDevicePtr device;
+namespace {
 
-bool Haptics::initDevice() {
-    cHapticDeviceHandler handler;
-    return handler.getDevice(device, 0) && device->open();
+Registro::Modulo g_log{"haptico"};
+
+// Últimas amostras por tick, para montar leituras alinhadas entre dispositivos
+constexpr int HISTORICO = 16;
+// Prioridade SCHED_FIFO pedida para as threads servo (só tem efeito com permissão)
+constexpr int PRIORIDADE_SERVO = 80;
+// Folga entre abrir os dispositivos e o tick 0 comum, para todas as threads chegarem a tempo
+constexpr uint64_t ATRASO_EPOCA_NS = 5000000ull;
+
+struct Dispositivo {
+    cGenericHapticDevicePtr device;
+    LacoServo servo;
+    CanalEstado<HapticSample> estado;              // Publicado pela thread servo
+    CanalEstado<HapticSample> historico[HISTORICO]; // estado[tick % HISTORICO]
+    CanalEstado<HapticVec3> forca;                 // Publicado por quem chama setForce
+    GanchosServo ganchos;                          // Broker, gravador
+};
+
+Dispositivo g_dispositivos[Haptics::MAX_DISPOSITIVOS];
+std::atomic<int> g_quantidade{0};
+
+void iteracaoServo(Dispositivo& d, uint64_t tick, uint64_t inicioNs) {
+    HapticSample s;
+    s.tick = tick;
+    s.timestampNs = inicioNs;
+
+    cVector3d v;
+    cMatrix3d r;
+    unsigned int botoes = 0;
+    if (d.device->getPosition(v)) s.position = HapticVec3{ v.x(), v.y(), v.z() };
+    if (d.device->getLinearVelocity(v)) s.velocity = HapticVec3{ v.x(), v.y(), v.z() };
+    if (d.device->getRotation(r)) {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                s.rotation.m[i * 3 + j] = r(i, j);
+    }
+    if (d.device->getUserSwitches(botoes)) s.buttons = botoes;
+
+    // Parada de emergência anula tudo; depois, comando de um cliente do broker tem
+    // prioridade; sem comando publicado: força zero
+    const bool parada = ParadaEmergencia::ativa();
+    if (parada) s.force = HapticVec3{};
+    else if (!d.ganchos.forcaExterna(inicioNs, s.force)) d.forca.ler(s.force);
+    d.device->setForce(cVector3d(s.force.x, s.force.y, s.force.z));
+    if (parada) ParadaEmergencia::confirmarForcaZero();
+
+    d.estado.publicar(s);
+    d.historico[tick % HISTORICO].publicar(s);
+    d.ganchos.notificar(s);
+}
+
+// Núcleo dedicado para o servo do dispositivo: a partir do último, nunca o 0 (UI)
+int nucleoDedicado(int indice) {
+    int nucleos = (int)std::thread::hardware_concurrency();
+    int nucleo = nucleos - 1 - indice;
+    return nucleo >= 1 ? nucleo : -1;
+}
+
+bool indiceValido(int indice) {
+    return indice >= 0 && indice < g_quantidade.load(std::memory_order_acquire);
+}
+
+} // namespace
+
+bool Haptics::initDevice(double taxaHz, bool tempoReal) {
+    cHapticDeviceHandler handler; // Nova enumeração a cada chamada, para enxergar dispositivos reconectados
+    const int disponiveis = std::min((int)handler.getNumDevices(), MAX_DISPOSITIVOS);
+    if (isRunning()) {
+        if (disponiveis == deviceCount()) return true;
+        shutdown(); // Dispositivo entrou ou saiu: reabre todos com uma nova época comum
+    }
+
+    int abertos = 0;
+    for (int i = 0; i < disponiveis; ++i) {
+        Dispositivo& d = g_dispositivos[abertos];
+        if (!(handler.getDevice(d.device, i) && d.device->open())) {
+            Registro::aviso(g_log, "Dispositivo háptico {} não pôde ser aberto.", i);
+            d.device = nullptr;
+            continue;
+        }
+        d.forca.publicar(HapticVec3{});
+        abertos++;
+    }
+    if (abertos == 0) return false;
+
+    // Todos os laços compartilham a mesma época: o tick k de cada dispositivo é agendado
+    // para o mesmo instante do relógio monotônico, então amostras de mesmo tick são simultâneas
+    const uint64_t epoca = relogioMonotonicoNs() + ATRASO_EPOCA_NS;
+    for (int i = 0; i < abertos; ++i) {
+        OpcoesServo opcoes;
+        opcoes.nucleo = nucleoDedicado(i);
+        opcoes.prioridadeFifo = PRIORIDADE_SERVO;
+        opcoes.epocaNs = epoca;
+        opcoes.tempoReal = tempoReal;
+        Dispositivo* d = &g_dispositivos[i];
+        if (!d->servo.iniciar("haptic-servo-" + std::to_string(i), taxaHz,
+                              [d](uint64_t tick, uint64_t inicioNs) { iteracaoServo(*d, tick, inicioNs); }, opcoes)) {
+            g_quantidade.store(i, std::memory_order_release);
+            shutdown();
+            return false;
+        }
+        Registro::info(g_log, "Dispositivo háptico {}: servo a {} Hz{}", i, taxaHz,
+                       opcoes.nucleo >= 0 ? ", núcleo " + std::to_string(opcoes.nucleo) : std::string());
+    }
+    g_quantidade.store(abertos, std::memory_order_release);
+    return true;
 }
 
 void Haptics::shutdown() {
-    if(device) device->close();
+    g_quantidade.store(0, std::memory_order_release); // Leitores deixam de ver os dispositivos antes do fechamento
+    for (int i = 0; i < MAX_DISPOSITIVOS; ++i) {
+        Dispositivo& d = g_dispositivos[i];
+        d.servo.parar();
+        if (d.device) {
+            d.device->setForce(cVector3d(0.0, 0.0, 0.0));
+            d.device->close();
+            d.device = nullptr;
+        }
+    }
+}
+
+bool Haptics::isRunning() {
+    return g_quantidade.load(std::memory_order_acquire) > 0 && g_dispositivos[0].servo.rodando();
+}
+
+int Haptics::deviceCount() {
+    return g_quantidade.load(std::memory_order_acquire);
+}
+
+bool Haptics::readState(HapticSample& amostra) {
+    return readState(0, amostra);
+}
+
+bool Haptics::readState(int indice, HapticSample& amostra) {
+    return indiceValido(indice) && g_dispositivos[indice].estado.ler(amostra);
+}
+
+int Haptics::readAlignedStates(HapticSample* amostras, int maximo, int* desalinhadas) {
+    if (desalinhadas) *desalinhadas = 0;
+    const int n = std::min(deviceCount(), maximo);
+    if (n <= 0) return 0;
+    // O tick mais antigo entre os "últimos" de cada dispositivo já foi publicado por todos
+    uint64_t tick = UINT64_MAX;
+    for (int i = 0; i < n; ++i) {
+        HapticSample s;
+        if (!g_dispositivos[i].estado.ler(s)) return 0;
+        tick = std::min(tick, s.tick);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (!g_dispositivos[i].historico[tick % HISTORICO].ler(amostras[i]) || amostras[i].tick != tick) {
+            // Dispositivo adiantado mais de HISTORICO ticks (ou escrevendo agora): usa a última amostra
+            if (!g_dispositivos[i].estado.ler(amostras[i])) return 0;
+            if (desalinhadas && amostras[i].tick != tick) ++*desalinhadas;
+        }
+    }
+    return n;
+}
+
+bool Haptics::getPosition(HapticVec3& posicao) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    posicao = s.position;
+    return true;
+}
+
+bool Haptics::getLinearVelocity(HapticVec3& velocidade) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    velocidade = s.velocity;
+    return true;
+}
+
+bool Haptics::getRotation(HapticMat3& rotacao) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    rotacao = s.rotation;
+    return true;
+}
+
+bool Haptics::getUserSwitches(uint32_t& botoes) {
+    HapticSample s;
+    if (!readState(s)) return false;
+    botoes = s.buttons;
+    return true;
+}
+
+bool Haptics::setForce(const HapticVec3& forca) {
+    return setForce(0, forca);
+}
+
+bool Haptics::setForce(int indice, const HapticVec3& forca) {
+    if (!indiceValido(indice) || !g_dispositivos[indice].servo.rodando()) return false;
+    g_dispositivos[indice].forca.publicar(forca);
+    return true;
+}
+
+const EstatisticasServo& Haptics::servoStats(int indice) {
+    return g_dispositivos[(indice >= 0 && indice < MAX_DISPOSITIVOS) ? indice : 0].servo.estatisticas();
+}
+
+GanchosServo& Haptics::servoHooks(int indice) {
+    return g_dispositivos[(indice >= 0 && indice < MAX_DISPOSITIVOS) ? indice : 0].ganchos;
 }
@@ -1,8 +1,46 @@
 // haptics.h
 #pragma once
 #include <chai3d.h>
+#include "haptic_types.h"
+#include "servo_hooks.h"
+#include "servo_stats.h"
 
 namespace Haptics {
-    bool initDevice();  // Apenas inicialização básica
+    constexpr double TAXA_SERVO_PADRAO_HZ = 1000.0;
+    constexpr int MAX_DISPOSITIVOS = 4;
+
+    // Abre todos os dispositivos conectados (até MAX_DISPOSITIVOS), cada um com seu
+    // laço servo (taxaHz) numa thread fixada em núcleo próprio, com SCHED_FIFO quando
+    // permitido. Os laços compartilham a época do relógio monotônico, então o tick k
+    // de cada dispositivo é agendado para o mesmo instante.
+    // Pode ser chamada de novo (reconexão via hotplug); se a quantidade de
+    // dispositivos mudou, todos são reabertos. tempoReal liga o modo de realtime.h.
+    bool initDevice(double taxaHz = TAXA_SERVO_PADRAO_HZ, bool tempoReal = false);
     void shutdown();
+    bool isRunning();
+    int deviceCount();
+
+    // Última amostra publicada pela thread servo. Sem locks; pode ser chamada de
+    // qualquer thread (UI, loggers) a qualquer frequência. Sem índice: dispositivo 0.
+    bool readState(HapticSample& amostra);
+    bool readState(int indice, HapticSample& amostra);
+    // Amostras de todos os dispositivos do mesmo tick (mesmo instante agendado).
+    // Retorna quantos dispositivos foram preenchidos. Um dispositivo adiantado além
+    // do histórico entra com a última amostra, de outro tick: essas são contadas em
+    // 'desalinhadas' (se não for nulo) e podem ser reconhecidas pelo campo tick.
+    int readAlignedStates(HapticSample* amostras, int maximo, int* desalinhadas = nullptr);
+
+    // Leitura/escrita do dispositivo; mesma API de HapticSimulator.
+    // setForce deve ser chamada por uma única thread; a força é aplicada na próxima iteração do servo.
+    bool getPosition(HapticVec3& posicao);
+    bool getLinearVelocity(HapticVec3& velocidade);
+    bool getRotation(HapticMat3& rotacao);
+    bool getUserSwitches(uint32_t& botoes);
+    bool setForce(const HapticVec3& forca);
+    bool setForce(int indice, const HapticVec3& forca);
+
+    // Jitter e prazos perdidos do laço servo (leitura sem locks).
+    const EstatisticasServo& servoStats(int indice = 0);
+    // Observadores de amostras e fonte de força externa da thread servo.
+    GanchosServo& servoHooks(int indice = 0);
 }
@@ -0,0 +1,12 @@
+// icons.h
+#pragma once
+
+// Ícones Font Awesome 6 Free (Solid) usados na interface, em UTF-8.
+// Somente os ícones listados aqui entram no atlas de fontes (ver glyph_ranges.h),
+// então qualquer ícone novo precisa ser declarado neste arquivo.
+#define ICON_FA_MAGNIFYING_GLASS "\xef\x80\x82" // U+F002
+#define ICON_FA_BOOK             "\xef\x80\xad" // U+F02D
+#define ICON_FA_PLAY             "\xef\x81\x8b" // U+F04B
+#define ICON_FA_GAMEPAD          "\xef\x84\x9b" // U+F11B
+#define ICON_FA_HAND             "\xef\x89\x96" // U+F256
+#define ICON_FA_STAR             "\xef\x80\x85" // U+F005
@@ -0,0 +1,427 @@
+#include "logger.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Registro::Nivel;
+using Registro::detalhe::Tipo;
+
+namespace {
+
+constexpr size_t MAX_ARGUMENTOS = 8;
+constexpr size_t TAMANHO_REGISTRO = 256;
+constexpr size_t REGISTROS_POR_THREAD = 512; // Potência de 2: 128 KiB por thread que registra
+constexpr auto INTERVALO_DRENAGEM = std::chrono::milliseconds(20);
+constexpr const char* SOCKET_JOURNAL = "/run/systemd/journal/socket";
+
+struct Cabecalho {
+    int64_t ns;                        // CLOCK_REALTIME
+    const Registro::Modulo* modulo;
+    const char* formato;
+    Nivel nivel;
+    uint8_t quantidade;
+    uint16_t bytesTexto;
+    Tipo tipos[MAX_ARGUMENTOS];
+    uint64_t valores[MAX_ARGUMENTOS];  // Textos: deslocamento em 'texto' | tamanho << 32
+};
+
+// Registro binário de tamanho fixo; os textos dos argumentos são copiados (truncados) para dentro dele
+struct RegistroBinario : Cabecalho {
+    char texto[TAMANHO_REGISTRO - sizeof(Cabecalho)];
+};
+static_assert(sizeof(RegistroBinario) == TAMANHO_REGISTRO, "Registro deve ocupar exatamente um slot");
+
+// Anel de uma thread: ela é a única produtora e a thread de fundo a única consumidora
+struct Anel {
+    RegistroBinario registros[REGISTROS_POR_THREAD];
+    alignas(64) std::atomic<uint64_t> escrita{0};
+    alignas(64) std::atomic<uint64_t> leitura{0};
+    std::atomic<uint64_t> descartados{0};
+    std::atomic<bool> emUso{true};
+    Anel* proximo = nullptr;
+};
+
+// Os anéis nunca são liberados; o de uma thread que terminou é reaproveitado pela próxima
+std::atomic<Anel*> g_aneis{nullptr};
+
+struct DonoAnel {
+    Anel* anel = nullptr;
+    ~DonoAnel() { if (anel) anel->emUso.store(false, std::memory_order_release); }
+};
+
+Anel& anelDaThread() {
+    thread_local DonoAnel dono;
+    if (dono.anel) return *dono.anel;
+    for (Anel* a = g_aneis.load(std::memory_order_acquire); a; a = a->proximo) {
+        bool livre = false;
+        if (a->emUso.compare_exchange_strong(livre, true, std::memory_order_acquire)) return *(dono.anel = a);
+    }
+    Anel* novo = new Anel();
+    novo->proximo = g_aneis.load(std::memory_order_relaxed);
+    while (!g_aneis.compare_exchange_weak(novo->proximo, novo, std::memory_order_release, std::memory_order_relaxed)) {}
+    return *(dono.anel = novo);
+}
+
+const char* nomeNivel(Nivel nivel) {
+    switch (nivel) {
+        case Nivel::Depuracao: return "DEPURAÇÃO";
+        case Nivel::Info:      return "INFO";
+        case Nivel::Aviso:     return "AVISO";
+        case Nivel::Erro:      return "ERRO";
+        default:               return "?";
+    }
+}
+
+// Prioridades do syslog, usadas pelo journal
+int prioridadeJournal(Nivel nivel) {
+    switch (nivel) {
+        case Nivel::Depuracao: return 7;
+        case Nivel::Info:      return 6;
+        case Nivel::Aviso:     return 4;
+        default:               return 3;
+    }
+}
+
+void anexarArgumento(const RegistroBinario& r, size_t i, std::string& saida) {
+    char buf[32];
+    switch (r.tipos[i]) {
+        case Tipo::Inteiro:  std::snprintf(buf, sizeof(buf), "%lld", (long long)(int64_t)r.valores[i]); saida += buf; break;
+        case Tipo::Natural:  std::snprintf(buf, sizeof(buf), "%llu", (unsigned long long)r.valores[i]); saida += buf; break;
+        case Tipo::Booleano: saida += r.valores[i] ? "sim" : "não"; break;
+        case Tipo::Real: {
+            double d;
+            std::memcpy(&d, &r.valores[i], sizeof(d));
+            std::snprintf(buf, sizeof(buf), "%g", d);
+            saida += buf;
+            break;
+        }
+        case Tipo::Texto:
+            saida.append(r.texto + (uint32_t)r.valores[i], (size_t)(r.valores[i] >> 32));
+            break;
+    }
+}
+
+void formatarMensagem(const RegistroBinario& r, std::string& saida) {
+    size_t arg = 0;
+    for (const char* c = r.formato; *c; ++c) {
+        if (c[0] == '{' && c[1] == '}' && arg < r.quantidade) { anexarArgumento(r, arg++, saida); ++c; }
+        else saida += *c;
+    }
+}
+
+// Arquivo com rotação por tamanho: ao passar do limite, arquivo -> arquivo.1 -> ... -> arquivo.N
+class ArquivoRotativo {
+public:
+    bool abrir(const std::string& caminho, uint64_t limite, int antigos) {
+        this->caminho = caminho;
+        this->limite = limite;
+        this->antigos = antigos;
+        arquivo = std::fopen(caminho.c_str(), "ae");
+        if (!arquivo) return false;
+        std::fseek(arquivo, 0, SEEK_END);
+        bytes = (uint64_t)std::ftell(arquivo);
+        return true;
+    }
+
+    void escrever(const std::string& linha) {
+        if (!arquivo) return;
+        if (bytes > 0 && bytes + linha.size() > limite) rotacionar();
+        if (!arquivo) return;
+        std::fwrite(linha.data(), 1, linha.size(), arquivo);
+        bytes += linha.size();
+    }
+
+    void descarregar() { if (arquivo) std::fflush(arquivo); }
+    void fechar() { if (arquivo) std::fclose(arquivo); arquivo = nullptr; }
+
+private:
+    void rotacionar() {
+        std::fclose(arquivo);
+        for (int i = antigos - 1; i >= 1; --i)
+            std::rename((caminho + "." + std::to_string(i)).c_str(), (caminho + "." + std::to_string(i + 1)).c_str());
+        if (antigos > 0) std::rename(caminho.c_str(), (caminho + ".1").c_str());
+        arquivo = std::fopen(caminho.c_str(), "we");
+        bytes = 0;
+    }
+
+    std::string caminho;
+    FILE* arquivo = nullptr;
+    uint64_t bytes = 0;
+    uint64_t limite = 0;
+    int antigos = 0;
+};
+
+// Protocolo nativo do journald: um datagrama com campos "CHAVE=valor\n"
+class Journal {
+public:
+    bool abrir() {
+        fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (fd < 0) return false;
+        std::memset(&endereco, 0, sizeof(endereco));
+        endereco.sun_family = AF_UNIX;
+        std::strncpy(endereco.sun_path, SOCKET_JOURNAL, sizeof(endereco.sun_path) - 1);
+        return true;
+    }
+
+    void enviar(const RegistroBinario& r, const std::string& mensagem) {
+        if (fd < 0) return;
+        datagrama.clear();
+        datagrama += "PRIORITY=" + std::to_string(prioridadeJournal(r.nivel)) + "\n";
+        datagrama += "SYSLOG_IDENTIFIER=jardim\n";
+        datagrama += "JARDIM_MODULO=";
+        datagrama += r.modulo->nome();
+        datagrama += "\nMESSAGE=";
+        // Quebras de linha exigiriam o formato binário do campo; viram espaços
+        for (char c : mensagem) datagrama += c == '\n' ? ' ' : c;
+        datagrama += '\n';
+        sendto(fd, datagrama.data(), datagrama.size(), MSG_NOSIGNAL, (const sockaddr*)&endereco, sizeof(endereco));
+    }
+
+    void fechar() { if (fd >= 0) close(fd); fd = -1; }
+
+private:
+    int fd = -1;
+    sockaddr_un endereco{};
+    std::string datagrama;
+};
+
+struct Estado {
+    Registro::Configuracao config;
+    ArquivoRotativo arquivo;
+    Journal journal;
+    std::thread thread;
+    std::mutex mutex;                // Só para acordar a thread de fundo no encerramento
+    std::condition_variable cv;
+    bool parar = false;
+    std::vector<RegistroBinario> lote;
+    std::string mensagem;
+    std::string linha;
+    uint64_t descartadosInformados = 0;
+};
+
+Estado& estado() {
+    static auto* e = new Estado(); // Vivo até o fim: threads destacadas podem registrar durante o exit
+    return *e;
+}
+
+Registro::Modulo g_log{"registro"};
+
+void escreverRegistro(Estado& e, const RegistroBinario& r) {
+    e.mensagem.clear();
+    formatarMensagem(r, e.mensagem);
+
+    char momento[40];
+    time_t segundos = (time_t)(r.ns / 1000000000);
+    tm local;
+    localtime_r(&segundos, &local);
+    size_t n = std::strftime(momento, sizeof(momento), "%Y-%m-%d %H:%M:%S", &local);
+    std::snprintf(momento + n, sizeof(momento) - n, ".%03d", (int)(r.ns / 1000000 % 1000));
+
+    e.linha.clear();
+    e.linha += momento;
+    e.linha += ' ';
+    e.linha += nomeNivel(r.nivel);
+    e.linha += " [";
+    e.linha += r.modulo->nome();
+    e.linha += "] ";
+    e.linha += e.mensagem;
+    e.linha += '\n';
+
+    if (e.config.console) {
+        // O console mostra só a hora
+        std::ostream& saida = r.nivel >= Nivel::Aviso ? std::cerr : std::cout;
+        saida.write(e.linha.data() + 11, (std::streamsize)(e.linha.size() - 11));
+    }
+    e.arquivo.escrever(e.linha);
+    if (e.config.journal) e.journal.enviar(r, e.mensagem);
+}
+
+// Copia o que os anéis publicaram, ordena por momento entre threads e grava
+void drenar(Estado& e) {
+    e.lote.clear();
+    uint64_t descartados = 0;
+    for (Anel* a = g_aneis.load(std::memory_order_acquire); a; a = a->proximo) {
+        uint64_t l = a->leitura.load(std::memory_order_relaxed);
+        const uint64_t fim = a->escrita.load(std::memory_order_acquire);
+        for (; l < fim; ++l) e.lote.push_back(a->registros[l & (REGISTROS_POR_THREAD - 1)]);
+        a->leitura.store(l, std::memory_order_release);
+        descartados += a->descartados.load(std::memory_order_relaxed);
+    }
+    std::stable_sort(e.lote.begin(), e.lote.end(), [](const RegistroBinario& a, const RegistroBinario& b) { return a.ns < b.ns; });
+    for (const auto& r : e.lote) escreverRegistro(e, r);
+    if (descartados > e.descartadosInformados) {
+        Registro::aviso(g_log, "{} registros descartados (anel cheio)", descartados - e.descartadosInformados);
+        e.descartadosInformados = descartados;
+    }
+    if (!e.lote.empty()) {
+        e.arquivo.descarregar();
+        if (e.config.console) { std::cout.flush(); std::cerr.flush(); }
+    }
+}
+
+void executarThread() {
+    pthread_setname_np(pthread_self(), "registro");
+    Estado& e = estado();
+    e.lote.reserve(REGISTROS_POR_THREAD);
+    std::unique_lock<std::mutex> trava(e.mutex);
+    while (!e.parar) {
+        e.cv.wait_for(trava, INTERVALO_DRENAGEM);
+        trava.unlock();
+        drenar(e);
+        trava.lock();
+    }
+    trava.unlock();
+    drenar(e);
+    drenar(e); // O aviso de descartados, se houver
+}
+
+} // namespace
+
+struct Registro::ListaModulos {
+    static std::atomic<Modulo*>& cabeca() {
+        static std::atomic<Modulo*> lista{nullptr};
+        return lista;
+    }
+    static void inserir(Modulo* m) {
+        m->proximo = cabeca().load(std::memory_order_relaxed);
+        while (!cabeca().compare_exchange_weak(m->proximo, m)) {}
+    }
+    template <typename F>
+    static void paraCada(F f) { for (Modulo* m = cabeca().load(); m; m = m->proximo) f(*m); }
+};
+
+Registro::Modulo::Modulo(const char* nome) : nomeModulo(nome) {
+    ListaModulos::inserir(this);
+}
+
+void Registro::detalhe::gravar(const Modulo& modulo, Nivel nivel, const char* formato, const Argumento* argumentos, size_t quantidade) {
+    Anel& anel = anelDaThread();
+    const uint64_t e = anel.escrita.load(std::memory_order_relaxed);
+    if (e - anel.leitura.load(std::memory_order_acquire) >= REGISTROS_POR_THREAD) {
+        anel.descartados.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    RegistroBinario& r = anel.registros[e & (REGISTROS_POR_THREAD - 1)];
+    timespec agora;
+    clock_gettime(CLOCK_REALTIME, &agora);
+    r.ns = (int64_t)agora.tv_sec * 1000000000 + agora.tv_nsec;
+    r.modulo = &modulo;
+    r.formato = formato;
+    r.nivel = nivel;
+    r.quantidade = (uint8_t)std::min(quantidade, MAX_ARGUMENTOS);
+    size_t usado = 0;
+    for (size_t i = 0; i < r.quantidade; ++i) {
+        const Argumento& a = argumentos[i];
+        r.tipos[i] = a.tipo;
+        switch (a.tipo) {
+            case Tipo::Inteiro:  r.valores[i] = (uint64_t)a.i; break;
+            case Tipo::Natural:  r.valores[i] = a.u; break;
+            case Tipo::Booleano: r.valores[i] = a.b; break;
+            case Tipo::Real:     std::memcpy(&r.valores[i], &a.d, sizeof(a.d)); break;
+            case Tipo::Texto: {
+                // Textos longos (caminhos) mantêm o final, começando num caractere UTF-8 inteiro
+                const char* origem = a.texto;
+                size_t n = a.tamanho;
+                const size_t livre = sizeof(r.texto) - usado;
+                if (n > livre) {
+                    origem += n - livre;
+                    n = livre;
+                    while (n > 0 && ((unsigned char)*origem & 0xC0) == 0x80) { origem++; n--; }
+                }
+                std::memcpy(r.texto + usado, origem, n);
+                r.valores[i] = (uint64_t)usado | ((uint64_t)n << 32);
+                usado += n;
+                break;
+            }
+        }
+    }
+    r.bytesTexto = (uint16_t)usado;
+    anel.escrita.store(e + 1, std::memory_order_release);
+}
+
+bool Registro::lerNivel(const std::string& texto, Nivel& nivel) {
+    if (texto == "depuracao" || texto == "debug") nivel = Nivel::Depuracao;
+    else if (texto == "info") nivel = Nivel::Info;
+    else if (texto == "aviso" || texto == "warn") nivel = Nivel::Aviso;
+    else if (texto == "erro" || texto == "error") nivel = Nivel::Erro;
+    else if (texto == "desligado" || texto == "off") nivel = Nivel::Desligado;
+    else return false;
+    return true;
+}
+
+bool Registro::iniciar(const Configuracao& config) {
+    Estado& e = estado();
+    if (e.thread.joinable()) return true;
+    e.config = config;
+    ListaModulos::paraCada([&](Modulo& m) { m.definirNivel(config.nivel); });
+    std::string lista = config.modulos;
+    for (size_t inicio = 0; inicio < lista.size();) {
+        size_t fim = lista.find(',', inicio);
+        if (fim == std::string::npos) fim = lista.size();
+        const std::string item = lista.substr(inicio, fim - inicio);
+        inicio = fim + 1;
+        // Vários .cpp podem definir um módulo com o mesmo nome: o filtro vale para todos
+        const size_t igual = item.find('=');
+        Nivel nivel;
+        int encontrados = 0;
+        if (igual != std::string::npos && lerNivel(item.substr(igual + 1), nivel)) {
+            const std::string nome = item.substr(0, igual);
+            ListaModulos::paraCada([&](Modulo& m) { if (nome == m.nome()) { m.definirNivel(nivel); encontrados++; } });
+        }
+        if (encontrados == 0) aviso(g_log, "Filtro de módulo ignorado: {}", item);
+    }
+    if (!config.arquivo.empty() && !e.arquivo.abrir(config.arquivo, config.bytesPorArquivo, config.arquivosAntigos))
+        erro(g_log, "Não foi possível abrir o arquivo de registro {}: {}", config.arquivo, std::strerror(errno));
+    if (config.journal && !e.journal.abrir())
+        erro(g_log, "Journal indisponível: {}", std::strerror(errno));
+    e.thread = std::thread(executarThread);
+    static bool registrado = false;
+    if (!registrado) { std::atexit(encerrar); registrado = true; }
+    return true;
+}
+
+void Registro::encerrar() {
+    Estado& e = estado();
+    if (!e.thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> trava(e.mutex);
+        e.parar = true;
+    }
+    e.cv.notify_one();
+    e.thread.join();
+    e.arquivo.fechar();
+    e.journal.fechar();
+}
+
+uint64_t Registro::descartados() {
+    uint64_t total = 0;
+    for (Anel* a = g_aneis.load(std::memory_order_acquire); a; a = a->proximo) total += a->descartados.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool lerOpcoesRegistro(int argc, char** argv, Registro::Configuracao& config) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--log") == 0 && i + 1 < argc) config.arquivo = argv[++i];
+        else if (std::strcmp(argv[i], "--log-modules") == 0 && i + 1 < argc) config.modulos = argv[++i];
+        else if (std::strcmp(argv[i], "--journal") == 0) config.journal = true;
+        else if (std::strcmp(argv[i], "--quiet") == 0) config.console = false;
+        else if (std::strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (!Registro::lerNivel(argv[++i], config.nivel)) {
+                std::cerr << "Nível de registro inválido: " << argv[i] << " (depuracao, info, aviso, erro, desligado)" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
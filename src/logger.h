@@ -0,0 +1,105 @@
+// logger.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+
+// Registro (log) assíncrono e estruturado.
+//
+// Quem registra só copia um registro binário de tamanho fixo (momento, nível,
+// módulo, formato e argumentos tipados) para um anel da própria thread, sem
+// locks nem chamadas de sistema; se o anel estiver cheio o registro é
+// descartado e contado. Uma thread de fundo drena os anéis, ordena por
+// momento, formata e grava no console, num arquivo rotativo e, se pedido, no
+// journal do systemd. Assim o registro nunca bloqueia a UI nem o laço servo.
+//
+// O formato usa {} para cada argumento, na ordem: "Jogo {} terminou ({})".
+// 'formato' e o nome do módulo precisam ter vida estática (literais).
+namespace Registro {
+    enum class Nivel : uint8_t { Depuracao, Info, Aviso, Erro, Desligado };
+
+    struct ListaModulos;
+
+    // Um módulo por subsistema, definido estático no .cpp que o usa. O nível
+    // mínimo de cada um é ajustado por --log-modules e lido sem custo.
+    class Modulo {
+    public:
+        explicit Modulo(const char* nome);
+        Modulo(const Modulo&) = delete;
+        Modulo& operator=(const Modulo&) = delete;
+
+        const char* nome() const { return nomeModulo; }
+        bool habilitado(Nivel nivel) const { return (uint8_t)nivel >= minimo.load(std::memory_order_relaxed); }
+        void definirNivel(Nivel nivel) { minimo.store((uint8_t)nivel, std::memory_order_relaxed); }
+
+    private:
+        friend struct ListaModulos;
+        const char* nomeModulo;
+        std::atomic<uint8_t> minimo{(uint8_t)Nivel::Info};
+        Modulo* proximo = nullptr;
+    };
+
+    struct Configuracao {
+        std::string arquivo;                   // Vazio = sem arquivo
+        uint64_t bytesPorArquivo = 4u << 20;   // Rotação: arquivo, arquivo.1, ... arquivo.N
+        int arquivosAntigos = 3;
+        bool console = true;                   // Info em stdout, avisos e erros em stderr
+        bool journal = false;                  // Protocolo nativo do journald (sem libsystemd)
+        Nivel nivel = Nivel::Info;             // Padrão de todos os módulos
+        std::string modulos;                   // "catalogo=depuracao,jogos=aviso"
+    };
+
+    // Inicia a thread de fundo. Registros feitos antes ficam nos anéis e saem
+    // na primeira drenagem. encerrar() drena tudo e para; também roda no exit.
+    bool iniciar(const Configuracao& config);
+    void encerrar();
+
+    bool lerNivel(const std::string& texto, Nivel& nivel);
+    uint64_t descartados();
+
+    namespace detalhe {
+        enum class Tipo : uint8_t { Inteiro, Natural, Real, Texto, Booleano };
+
+        struct Argumento {
+            Tipo tipo;
+            union { int64_t i; uint64_t u; double d; bool b; };
+            const char* texto = nullptr;
+            size_t tamanho = 0;
+
+            template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+            Argumento(T v) {
+                if constexpr (std::is_signed_v<T>) { tipo = Tipo::Inteiro; i = v; }
+                else { tipo = Tipo::Natural; u = v; }
+            }
+            Argumento(bool v) : tipo(Tipo::Booleano), b(v) {}
+            Argumento(double v) : tipo(Tipo::Real), d(v) {}
+            Argumento(const char* v) : tipo(Tipo::Texto), u(0), texto(v ? v : "(nulo)"), tamanho(std::char_traits<char>::length(texto)) {}
+            Argumento(const std::string& v) : tipo(Tipo::Texto), u(0), texto(v.data()), tamanho(v.size()) {}
+            Argumento(const std::filesystem::path& v) : Argumento(v.native()) {}
+        };
+
+        void gravar(const Modulo& modulo, Nivel nivel, const char* formato, const Argumento* argumentos, size_t quantidade);
+    }
+
+    template <typename... Args>
+    void registrar(const Modulo& modulo, Nivel nivel, const char* formato, const Args&... args) {
+        if (!modulo.habilitado(nivel)) return;
+        if constexpr (sizeof...(Args) == 0) {
+            detalhe::gravar(modulo, nivel, formato, nullptr, 0);
+        } else {
+            const detalhe::Argumento argumentos[] = { detalhe::Argumento(args)... };
+            detalhe::gravar(modulo, nivel, formato, argumentos, sizeof...(Args));
+        }
+    }
+
+    template <typename... Args> void depuracao(const Modulo& m, const char* f, const Args&... a) { registrar(m, Nivel::Depuracao, f, a...); }
+    template <typename... Args> void info(const Modulo& m, const char* f, const Args&... a) { registrar(m, Nivel::Info, f, a...); }
+    template <typename... Args> void aviso(const Modulo& m, const char* f, const Args&... a) { registrar(m, Nivel::Aviso, f, a...); }
+    template <typename... Args> void erro(const Modulo& m, const char* f, const Args&... a) { registrar(m, Nivel::Erro, f, a...); }
+}
+
+// Lê --log arquivo, --log-level nivel, --log-modules lista, --journal e --quiet.
+// Retorna false se um nível for inválido.
+bool lerOpcoesRegistro(int argc, char** argv, Registro::Configuracao& config);
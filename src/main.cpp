@@ -2,7 +2,7 @@
 #include "stb_image.h"
 
 #include <thread>
-#include <csignal>
+#include <atomic>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <filesystem>
@@ -15,12 +15,42 @@
 #include <sstream>
 #include <cstring>
 #include <ctime>
+#include <cmath>
 #include <cstdint> // Para uintptr_t
+#include <chrono>
+#include <functional>
+#include <fstream>
+#include <memory>
 #include "config_parser.h"
+#include "glyph_ranges.h"
+#include "icons.h"
+#include "logger.h"
+#include "metrics.h"
+#include "perf_counters.h"
+#include "text_layout_cache.h"
+#include "game_filter.h"
+#include "game_discovery.h"
+#include "alloc_tracker.h"
+#include "async_stage.h"
+#include "card_layout.h"
+#include "frame_profiler.h"
+#include "bench.h"
+#include "device_init.h"
+#include "device_manager.h"
+#include "emergency_stop.h"
+#include "event_loop.h"
+#include "haptic_broker.h"
+#include "haptic_recording.h"
+#include "process_launcher.h"
+#include "realtime.h"
+#include "trace.h"
+#include "watchdog.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include <jsoncpp/json/json.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
 
 #if DISABLE_HAPTICS == 0
 #include "haptics.h"
@@ -31,12 +61,17 @@
 namespace fs = std::filesystem;
 
 // --- Declarações Antecipadas ---
-std::vector<fs::path> listarDesafios(const fs::path& dir);
 bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_width, int* out_height);
 
 // --- Configurações e Constantes Globais ---
-volatile sig_atomic_t emergency_stop = 0;
+// Módulos de registro (filtráveis com --log-modules)
+Registro::Modulo g_logSistema{"sistema"};
+Registro::Modulo g_logCatalogo{"catalogo"};
+Registro::Modulo g_logInterface{"interface"};
+Registro::Modulo g_logJogos{"jogos"};
+std::atomic<bool> emergency_stop{false};
 std::vector<GameInfo> games;
+Metricas::Medidor g_metricaCatalogo{"jardim_catalog_games", "Jogos no catálogo carregado."};
 
 const char* FONT_DIR = "fonts/";
 const char* ROBOTO_FONT_FILE = "Roboto-Medium.ttf";
@@ -44,20 +79,151 @@ const char* ICONS_FONT_FILE = "Font Awesome 6 Free-Solid-900.otf";
 // ATUALIZE O CAMINHO DA IMAGEM SE NECESSÁRIO
 const char* BACKGROUND_IMAGE_PATH = "assets/pankaj-shah-1ff_i7jO-4g-unsplash.jpg";
 
-const fs::path CHAI3D_EXAMPLES_DIR = "/home/igor/chai3d-3.2.0-Makefiles/chai3d-3.2.0/bin/lin-x86_64";
+const char* PROJECT_TITLE = "Projeto Jardim";
+
+// Histogramas de jitter do laço servo, gravados ao sair e pelo menu Arquivo
+const char* SERVO_STATS_PATH = "haptic_servo_stats.txt";
+
+// Textos fixos da interface. Ficam centralizados aqui para que o atlas de fontes
+// seja construído apenas com os glifos (acentos e ícones) que realmente aparecem.
+namespace Textos {
+const char* MENU_ARQUIVO        = "Arquivo";
+const char* MENU_SAIR           = "Sair";
+const char* MENU_SALVAR_SERVO   = "Salvar estatísticas do servo";
+const char* MENU_PARADA         = "Parada de emergência";
+const char* MENU_RASTREAMENTO   = "Salvar rastreamento";
+const char* MENU_EXIBIR         = "Exibir";
+const char* MENU_PERFILADOR     = "Perfilador de quadros";
+const char* JANELA_FILTROS      = "Filtros e Pesquisa";
+const char* PESQUISAR           = ICON_FA_MAGNIFYING_GLASS " Pesquisar por termo:";
+const char* PESQUISAR_DICA      = "Digite descrição, matéria, etc.";
+const char* ABA_MATERIAS        = ICON_FA_BOOK " Matérias";
+const char* TODAS_MATERIAS      = "Todas Matérias";
+const char* ABA_HABILIDADES     = ICON_FA_STAR " Habilidades";
+const char* TODAS_HABILIDADES   = "Todas Habilidades";
+const char* JOGOS_DISPONIVEIS   = ICON_FA_GAMEPAD " Jogos Disponíveis";
+const char* NENHUM_JOGO         = "Nenhum jogo encontrado com os filtros atuais.";
+const char* BOTAO_INICIAR       = ICON_FA_PLAY " INICIAR";
+const char* STATUS_DISPOSITIVO  = ICON_FA_HAND " Dispositivo: %s (%s) | Jogos carregados: %zu | %s";
+const char* MODO_SIMULACAO      = "Simulação";
+const char* MODO_REAL           = "Real";
+const char* PRESENCA_CONECTADO  = "conectado";
+const char* PRESENCA_VARIOS     = "%d conectados";
+const char* PRESENCA_CONECTANDO = "conectando...";
+const char* PRESENCA_AUSENTE    = "desconectado";
+const char* PRESENCA_FALHA      = "falha ao abrir";
+const char* PRESENCA_SEM_RESPOSTA = "sem resposta";
+const char* INICIAR_AGUARDANDO  = "Aguardando o dispositivo háptico";
+const char* STATUS_HAPTICO      = "Posição: (%+.1f, %+.1f, %+.1f) mm | Botões: %02X | Força: %.2f N";
+const char* STATUS_HAPTICO_INDICE = "#%d";
+const char* STATUS_BROKER       = "Jogo conectado ao broker";
+const char* STATUS_SERVO        = "Servo: %.0f Hz | Jitter p99: %.0f µs | Prazos perdidos: %llu";
+const char* CARREGANDO_CATALOGO = "Carregando catálogo de jogos...";
+const char* CATALOGO_FALHOU     = "Não foi possível carregar o catálogo de jogos (veja o log).";
+
+const std::vector<const char*> TODOS = {
+    MENU_ARQUIVO, MENU_SAIR, MENU_SALVAR_SERVO, MENU_PARADA, MENU_RASTREAMENTO, MENU_EXIBIR, MENU_PERFILADOR, JANELA_FILTROS, PESQUISAR, PESQUISAR_DICA, ABA_MATERIAS, TODAS_MATERIAS,
+    ABA_HABILIDADES, TODAS_HABILIDADES, JOGOS_DISPONIVEIS, NENHUM_JOGO, BOTAO_INICIAR,
+    STATUS_DISPOSITIVO, MODO_SIMULACAO, MODO_REAL, PRESENCA_CONECTADO, PRESENCA_VARIOS, PRESENCA_CONECTANDO,
+    PRESENCA_AUSENTE, PRESENCA_FALHA, PRESENCA_SEM_RESPOSTA, INICIAR_AGUARDANDO, STATUS_HAPTICO, STATUS_HAPTICO_INDICE, STATUS_BROKER, STATUS_SERVO,
+    CARREGANDO_CATALOGO, CATALOGO_FALHOU,
+};
+}
+
+// Raiz usada só quando nem JARDIM_GAMES_PATH nem "search_paths" do config indicam onde procurar.
+// Vem da variável CHAI3D_EXAMPLES_DIR do CMake, a mesma que preenche o games_config.json.
+#ifndef JARDIM_CHAI3D_EXAMPLES_DIR
+#define JARDIM_CHAI3D_EXAMPLES_DIR ""
+#endif
+const fs::path CHAI3D_EXAMPLES_DIR = JARDIM_CHAI3D_EXAMPLES_DIR;
 
 std::set<std::string> g_availableSubjects;
 std::set<std::string> g_availableSkills;
 
+#if DISABLE_HAPTICS == 1
+HapticSimulator::Config g_configSimulador; // Preenchido a partir de --sim-rate / --sim-trajectory
+#else
+GerenciadorDispositivos g_dispositivos; // Hotplug USB do dispositivo real
+#endif
+
+// Modo de tempo real opcional para as threads servo (--realtime)
+bool g_tempoReal = false;
+
+// Modo benchmark (--bench): sem dispositivo nem etapas em segundo plano
+bool g_modoBench = false;
+
+// Abertura do dispositivo (ou do simulador) fora da thread da UI, com prazo
+InicializacaoDispositivo g_inicializacaoHaptica;
+constexpr auto PRAZO_INICIALIZACAO_HAPTICA = std::chrono::seconds(5);
+#if DISABLE_HAPTICS == 0
+// Dispositivo removido durante uma abertura que passou do prazo: a própria
+// tentativa fecha o que abriu ao terminar
+std::atomic<bool> g_fechamentoPendente{false};
+#endif
+
+// Os jogos usam o dispositivo através do launcher, via memória compartilhada
+ServidorBroker g_broker;
+
+// Gravação do fluxo háptico (--record-haptics), reproduzível com --sim-replay
+std::string g_caminhoGravacao;
+GravadorHaptico g_gravador;
+
+// Rastreamento em formato Chrome (--trace arquivo.json), salvo pelo menu e ao sair
+std::string g_caminhoRastreamento;
+
 GLuint background_texture_id = 0;
 int background_width = 0;
 int background_height = 0;
 
+// --- Inicialização em etapas ---
+// A janela aparece logo com a interface mínima (fonte embutida do ImGui, sem
+// catálogo); catálogo, fontes e imagem de fundo são carregados em threads de
+// trabalho e adotados pela thread da UI entre quadros, quando ficam prontos.
+struct CatalogoCarregado {
+    std::vector<GameInfo> jogos;
+    bool ok = false;
+    fs::path arquivoConfig;         // Observados pelo laço de eventos para recarregar
+    std::vector<fs::path> raizes;
+};
+
+struct LiberarStbi { void operator()(unsigned char* p) const { stbi_image_free(p); } };
+struct ImagemDecodificada {
+    std::unique_ptr<unsigned char, LiberarStbi> pixels; // RGBA
+    int largura = 0;
+    int altura = 0;
+};
+
+// Conteúdo dos arquivos de fonte; o atlas os referencia sem copiar (FontDataOwnedByAtlas = false)
+struct ArquivosFonte {
+    std::vector<char> roboto;
+    std::vector<char> icones;
+};
+
+EtapaAssincrona<CatalogoCarregado> g_etapaCatalogo;
+EtapaAssincrona<ArquivosFonte> g_etapaFontes;
+EtapaAssincrona<ImagemDecodificada> g_etapaFundo;
+ArquivosFonte g_arquivosFonte;      // Adotados; vivos enquanto o atlas existir
+bool g_catalogoFalhou = false;
+uint64_t g_versaoCatalogo = 0;      // Muda a cada catálogo adotado (filtro e layout recalculam)
+
+// --- Laço de eventos ---
+// A thread da UI dorme em g_laco.aguardar() até haver entrada do servidor
+// gráfico, término de jogo, mudança no catálogo em disco, etapa concluída,
+// SIGUSR1 ou o tique do painel háptico.
+LacoEventos g_laco;
+int g_timerRecarga = -1;
+std::vector<int> g_observacoesCatalogo;
+std::vector<fs::path> g_caminhosObservados;
+constexpr auto ESPERA_RECARGA = std::chrono::milliseconds(200); // Agrupa as escritas de uma cópia ou compilação
+constexpr auto PERIODO_STATUS = std::chrono::milliseconds(100); // Painel háptico a 10 Hz quando ocioso
+constexpr int QUADROS_APOS_EVENTO = 3; // O ImGui precisa de alguns quadros para assentar hover e foco
+
 
 // --- Handlers ---
-void emergency_handler(int sig) {
-    emergency_stop = 1;
-    std::cerr << "\nPARADA DE EMERGÊNCIA! Sinal: " << sig << std::endl;
+// Roda na thread de emergência, depois da força zero e dos jogos sinalizados
+void aoPararEmergencia() {
+    emergency_stop = true;
+    g_laco.acordar();
 }
 
 // --- Funções Auxiliares UI ---
@@ -78,19 +244,21 @@ bool ButtonCustom(const char* label, const ImVec2& size) {
 }
 
 // --- Carregador de Textura com Debug Detalhado ---
-bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_width, int* out_height) {
-    std::cout << "Tentando carregar imagem de: ";
-    // Tenta imprimir o caminho absoluto. fs::absolute pode falhar se o arquivo não existir ou o caminho for inválido.
+// Leitura e decodificação da imagem, sem OpenGL: pode rodar numa thread de trabalho
+bool decodificarImagem(const char* filename, ImagemDecodificada& imagem) {
+    EscopoRastreio rastreio("decodificarImagem", "inicializacao", filename);
+    EscopoContadores contadores("decodificarImagem");
+    // Tenta registrar o caminho absoluto. fs::absolute pode falhar se o arquivo não existir ou o caminho for inválido.
     try {
         // Certifique-se que 'filename' não é nulo antes de chamar fs::absolute
         if (filename) {
-            std::cout << fs::absolute(fs::path(filename)).string() << std::endl;
+            Registro::info(g_logInterface, "Tentando carregar imagem de: {}", fs::absolute(fs::path(filename)));
         } else {
-            std::cout << "[caminho nulo]" << std::endl;
+            Registro::erro(g_logInterface, "Tentando carregar imagem de: [caminho nulo]");
             return false; // Não pode carregar um arquivo nulo
         }
     } catch (const fs::filesystem_error& e) {
-        std::cout << filename << " (erro ao obter caminho absoluto: " << e.what() << ")" << std::endl;
+        Registro::aviso(g_logInterface, "Tentando carregar imagem de: {} (erro ao obter caminho absoluto: {})", filename, e.what());
             // Continua tentando carregar com o caminho relativo, pois fs::absolute pode falhar em alguns cenários
     }
 
@@ -100,10 +268,10 @@ bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_wid
 
     // 1. Tenta obter informações sobre a imagem sem decodificar os pixels
     if (stbi_info(filename, &image_width_test, &image_height_test, &channels_in_file_test)) {
-        std::cout << "STB INFO: Arquivo '" << filename << "' parece ser uma imagem válida. Dimensões: "
-                  << image_width_test << "x" << image_height_test << ", Canais no arquivo: " << channels_in_file_test << std::endl;
+        Registro::depuracao(g_logInterface, "STB INFO: Arquivo '{}' parece ser uma imagem válida. Dimensões: {}x{}, Canais no arquivo: {}",
+                            filename, image_width_test, image_height_test, channels_in_file_test);
     } else {
-        std::cerr << "STB INFO: Não foi possível obter informações do arquivo '" << filename << "'. Razão: " << stbi_failure_reason() << std::endl;
+        Registro::aviso(g_logInterface, "STB INFO: Não foi possível obter informações do arquivo '{}'. Razão: {}", filename, stbi_failure_reason());
         // Não retorna false aqui, pois stbi_load pode ter mais sorte ou dar um erro diferente.
     }
 
@@ -113,12 +281,23 @@ bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_wid
     unsigned char* image_data = stbi_load(filename, &image_width, &image_height, NULL, 4);
 
     if (image_data == NULL) {
-        std::cerr << "STB LOAD (forçando 4 canais): Erro ao carregar imagem '" << filename << "'. Razão: " << stbi_failure_reason() << std::endl;
+        Registro::erro(g_logInterface, "STB LOAD (forçando 4 canais): Erro ao carregar imagem '{}'. Razão: {}", filename, stbi_failure_reason());
         return false;
     }
 
-    std::cout << "STB LOAD (forçando 4 canais): Imagem carregada com sucesso. Dimensões: "
-              << image_width << "x" << image_height << ". Dados em: " << (void*)image_data << std::endl;
+    Registro::depuracao(g_logInterface, "STB LOAD (forçando 4 canais): Imagem carregada com sucesso. Dimensões: {}x{}", image_width, image_height);
+    imagem.pixels.reset(image_data);
+    imagem.largura = image_width;
+    imagem.altura = image_height;
+    return true;
+}
+
+// Envio da imagem decodificada para a GPU; só na thread do contexto OpenGL
+bool criarTexturaDeImagem(const ImagemDecodificada& imagem, GLuint* out_texture, int* out_width, int* out_height) {
+    EscopoRastreio rastreio("criarTexturaDeImagem", "inicializacao");
+    EscopoContadores contadores("criarTexturaDeImagem");
+    const int image_width = imagem.largura;
+    const int image_height = imagem.altura;
 
     // Criar textura OpenGL
     glGenTextures(1, out_texture);
@@ -132,15 +311,12 @@ bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_wid
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 #endif
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, imagem.pixels.get());
     GLenum err = glGetError();
     if (err != GL_NO_ERROR) {
-        std::cerr << "Erro OpenGL após glTexImage2D: " << err << std::endl;
-        // Mesmo com erro OpenGL, precisamos liberar image_data
+        Registro::erro(g_logInterface, "Erro OpenGL após glTexImage2D: {}", err);
     }
 
-    stbi_image_free(image_data);
-
     *out_width = image_width;
     *out_height = image_height;
 
@@ -150,98 +326,238 @@ bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_wid
         return false;
     }
 
-    std::cout << "Textura OpenGL criada e dados carregados para: " << filename << std::endl;
+    Registro::info(g_logInterface, "Textura OpenGL criada ({}x{})", image_width, image_height);
     return true;
 }
 
+bool loadTextureFromFile(const char* filename, GLuint* out_texture, int* out_width, int* out_height) {
+    EscopoRastreio rastreio("loadTextureFromFile", "inicializacao", filename);
+    ImagemDecodificada imagem;
+    return decodificarImagem(filename, imagem) && criarTexturaDeImagem(imagem, out_texture, out_width, out_height);
+}
+
 
-// Implementação da listarDesafios
-std::vector<fs::path> listarDesafios(const fs::path& dir) {
-    std::vector<fs::path> executaveis;
-    if (!fs::exists(dir) || !fs::is_directory(dir)) { std::cerr << "Diretório de desafios não encontrado: " << dir << std::endl; return executaveis; }
-    for (const auto& entry : fs::directory_iterator(dir)) {
-        if (entry.is_regular_file()) {
-            try {
-                if ((entry.status().permissions() & fs::perms::owner_exec) != fs::perms::none ||
-                    (entry.status().permissions() & fs::perms::group_exec) != fs::perms::none ||
-                    (entry.status().permissions() & fs::perms::others_exec) != fs::perms::none) {
-                    executaveis.push_back(entry.path());
-                }
-            } catch (const fs::filesystem_error& e) { std::cerr << "Erro ao verificar permissões para " << entry.path() << ": " << e.what() << std::endl; }
-        }
+// Preenche as listas de matérias e habilidades exibidas nos filtros a partir de 'games'
+void popularCatalogo() {
+    g_metricaCatalogo.definir((double)games.size());
+    g_availableSubjects.clear(); g_availableSkills.clear();
+    for (const auto& game : games) {
+        g_availableSubjects.insert(game.cfg.subject);
+        for (const auto& skill : game.cfg.skills) g_availableSkills.insert(skill);
     }
-    return executaveis;
 }
 
 // --- Inicialização do Sistema ---
-bool inicializarSistema() {
-    std::signal(SIGINT, emergency_handler); std::signal(SIGTERM, emergency_handler); std::signal(SIGSEGV, emergency_handler);
+// Broker e gravação observam só o dispositivo 0
+GanchosServo& ganchosServo() {
 #if DISABLE_HAPTICS == 0
-    // ... (haptics init)
+    return Haptics::servoHooks();
 #else
-    HapticSimulator::init(); std::cout << "Modo simulação de hápticos ATIVADO." << std::endl;
+    return HapticSimulator::servoHooks();
 #endif
+}
+
+// Roda numa thread de trabalho: não toca em 'games' nem no ImGui
+CatalogoCarregado carregarCatalogo() {
+    EscopoRastreio rastreio("carregarCatalogo", "inicializacao");
+    EscopoContadores contadores("carregarCatalogo");
+    CatalogoCarregado catalogo;
     std::string configPath = "games_config.json";
-    if (!fs::exists(configPath)) { std::cerr << "Config não encontrado: " << fs::absolute(configPath) << std::endl; return false; }
-    auto configs = loadGameConfigs(configPath);
-    if (configs.empty()) { std::cerr << "Nenhuma config de jogo carregada: " << configPath << std::endl; }
-    std::cout << "Procurando desafios em: " << CHAI3D_EXAMPLES_DIR << std::endl;
-    for (const auto& execPath : listarDesafios(CHAI3D_EXAMPLES_DIR)) {
-        std::string nomeBaseExecutavel = execPath.stem().string();
-        if (configs.count(nomeBaseExecutavel)) { games.push_back(GameInfo{execPath, configs[nomeBaseExecutavel]}); }
-    }
-    if (games.empty()) { std::cerr << "Nenhum jogo carregado." << std::endl; return false; }
-    for (const auto& game : games) {
-        g_availableSubjects.insert(game.cfg.subject);
-        for (const auto& skill : game.cfg.skills) g_availableSkills.insert(skill);
+    catalogo.arquivoConfig = fs::absolute(configPath);
+    if (!fs::exists(configPath)) { Registro::erro(g_logCatalogo, "Config não encontrado: {}", catalogo.arquivoConfig); return catalogo; }
+    std::vector<fs::path> raizesArquivo;
+    auto configs = loadGameConfigs(configPath, &raizesArquivo);
+    if (configs.empty()) { Registro::erro(g_logCatalogo, "Nenhuma config de jogo carregada: {}", configPath); }
+    std::vector<VarreduraRaiz> varreduras;
+    catalogo.raizes = raizesDeBusca(raizesArquivo, CHAI3D_EXAMPLES_DIR);
+    catalogo.jogos = descobrirJogos(catalogo.raizes, configs, varreduras);
+    for (const auto& v : varreduras) {
+        if (v.sombreados > 0)
+            Registro::info(g_logCatalogo, "Procurando desafios em: {} -> {} jogos ({} já encontrados em raiz de maior prioridade) em {} ms",
+                           v.raiz, v.encontrados, v.sombreados, v.ms);
+        else
+            Registro::info(g_logCatalogo, "Procurando desafios em: {} -> {} jogos em {} ms", v.raiz, v.encontrados, v.ms);
+    }
+    if (catalogo.jogos.empty()) { Registro::erro(g_logCatalogo, "Nenhum jogo carregado."); return catalogo; }
+    catalogo.ok = true;
+    return catalogo;
+}
+
+bool inicializarSistema() {
+    EscopoRastreio rastreio("inicializarSistema", "inicializacao");
+    EscopoContadores contadores("inicializarSistema");
+    if (g_tempoReal) {
+        // Antes das threads servo: a memória travada vale para as pilhas delas também
+        TempoReal::RelatorioProcesso rt = TempoReal::prepararProcesso();
+        Registro::info(g_logSistema, "Tempo real: memória travada {}, heap pré-faltado {}{}{}{}", rt.memoriaTravada, rt.heapPreFaltado,
+                       rt.detalhes.empty() ? "" : " (", rt.detalhes, rt.detalhes.empty() ? "" : ")");
+#if DISABLE_HAPTICS == 1
+        g_configSimulador.tempoReal = true;
+#endif
+    }
+#if DISABLE_HAPTICS == 0
+    // O dispositivo é aberto e fechado conforme é conectado/removido. A abertura roda em
+    // segundo plano com prazo: a janela nunca espera por um dispositivo USB travado.
+    auto abrirDispositivo = [] {
+        g_inicializacaoHaptica.iniciar("dispositivo háptico", [] {
+            const bool ok = Haptics::initDevice(Haptics::TAXA_SERVO_PADRAO_HZ, g_tempoReal);
+            if (!g_fechamentoPendente.exchange(false)) return ok;
+            Haptics::shutdown(); // Removido enquanto abria: o handle aberto já não vale
+            return false;
+        }, PRAZO_INICIALIZACAO_HAPTICA);
+    };
+    // Na thread de trabalho do USB: pode esperar pela abertura em andamento
+    auto fecharDispositivo = [] {
+        g_inicializacaoHaptica.aguardar();
+        if (!g_inicializacaoHaptica.emAndamento()) {
+            Haptics::shutdown();
+            return;
+        }
+        // Abertura travada além do prazo: fica para ela, a menos que tenha acabado agora
+        g_fechamentoPendente.store(true);
+        if (!g_inicializacaoHaptica.emAndamento() && g_fechamentoPendente.exchange(false)) Haptics::shutdown();
+    };
+    if (!g_dispositivos.iniciar(GerenciadorDispositivos::VENDOR_FORCE_DIMENSION,
+                                [=] { abrirDispositivo(); return g_inicializacaoHaptica.aguardar(); }, fecharDispositivo)) {
+        Registro::aviso(g_logSistema, "Hotplug USB indisponível; abrindo o dispositivo uma única vez.");
+        abrirDispositivo();
+    }
+#else
+    g_inicializacaoHaptica.iniciar("simulador háptico", [] { return HapticSimulator::init(g_configSimulador); }, PRAZO_INICIALIZACAO_HAPTICA);
+    Registro::info(g_logSistema, "Modo simulação de hápticos ATIVADO.");
+#endif
+    if (!g_broker.iniciar(ganchosServo())) Registro::aviso(g_logSistema, "Broker háptico indisponível; jogos abrirão o dispositivo por conta própria.");
+    if (!g_caminhoGravacao.empty()) {
+#if DISABLE_HAPTICS == 0
+        const double taxaServo = Haptics::TAXA_SERVO_PADRAO_HZ;
+#else
+        const double taxaServo = g_configSimulador.taxaHz;
+#endif
+        g_gravador.iniciar(g_caminhoGravacao, taxaServo, ganchosServo());
     }
-    std::cout << "Sistema inicializado com " << games.size() << " jogos." << std::endl;
     return true;
 }
 
+// Um laço servo por dispositivo aberto; o 0 conta mesmo fechado, para o dump
+// depois de uma remoção
+int quantidadeServos() {
+#if DISABLE_HAPTICS == 0
+    return std::max(1, Haptics::deviceCount());
+#else
+    return 1;
+#endif
+}
+
+const EstatisticasServo& estatisticasServo(int indice) {
+#if DISABLE_HAPTICS == 0
+    return Haptics::servoStats(indice);
+#else
+    (void)indice;
+    return HapticSimulator::servoStats();
+#endif
+}
+
+// Roda na thread do servidor de métricas: só lê os atômicos das estatísticas
+// Uma série por dispositivo, com o rótulo device="i"
+void coletarServo(Metricas::Pagina& pagina) {
+    const int servos = quantidadeServos();
+    std::vector<std::string> rotulos;
+    for (int i = 0; i < servos; ++i) rotulos.push_back("device=\"" + std::to_string(i) + "\"");
+    pagina.cabecalho("jardim_haptic_loop_rate_hz", "Taxa medida do laço servo háptico.", "gauge");
+    for (int i = 0; i < servos; ++i) pagina.valor("jardim_haptic_loop_rate_hz", estatisticasServo(i).taxaMedidaHz(), rotulos[i]);
+    pagina.cabecalho("jardim_haptic_loop_nominal_rate_hz", "Taxa configurada do laço servo háptico.", "gauge");
+    for (int i = 0; i < servos; ++i) pagina.valor("jardim_haptic_loop_nominal_rate_hz", estatisticasServo(i).taxaNominalHz(), rotulos[i]);
+    pagina.cabecalho("jardim_haptic_loop_deadline_misses_total", "Iterações do servo que terminaram depois do início previsto da seguinte.", "counter");
+    for (int i = 0; i < servos; ++i) pagina.valor("jardim_haptic_loop_deadline_misses_total", (double)estatisticasServo(i).prazosPerdidos(), rotulos[i]);
+    // O mesmo jitter da barra de status
+    pagina.cabecalho("jardim_haptic_loop_jitter_seconds", "Maior desvio do período do servo em relação ao nominal, entre os percentis 1 e 99.", "gauge");
+    for (int i = 0; i < servos; ++i) pagina.valor("jardim_haptic_loop_jitter_seconds", estatisticasServo(i).jitterNs() / 1e9, rotulos[i]);
+    pagina.cabecalho("jardim_haptic_loop_period_seconds", "Intervalo entre inícios de iterações do servo.", "summary");
+    for (int i = 0; i < servos; ++i) pagina.seriesResumo("jardim_haptic_loop_period_seconds", estatisticasServo(i).periodo(), rotulos[i]);
+    pagina.cabecalho("jardim_haptic_loop_execution_seconds", "Tempo de execução de cada iteração do servo.", "summary");
+    for (int i = 0; i < servos; ++i) pagina.seriesResumo("jardim_haptic_loop_execution_seconds", estatisticasServo(i).tempoExecucao(), rotulos[i]);
+}
+
+Metricas::Coletor g_coletorServo{coletarServo};
+
+// Uma seção por dispositivo, com o nome da thread servo de cada um
+void salvarEstatisticasServo() {
+    std::ofstream arquivo;
+    for (int i = 0; i < quantidadeServos(); ++i) {
+        const EstatisticasServo& servo = estatisticasServo(i);
+        if (servo.iteracoes() == 0) continue;
+        if (!arquivo.is_open()) {
+            arquivo.open(SERVO_STATS_PATH);
+            if (!arquivo.is_open()) {
+                Registro::erro(g_logSistema, "Erro ao salvar estatísticas do servo em: {}", SERVO_STATS_PATH);
+                return;
+            }
+        }
+        const std::string nome = (DISABLE_HAPTICS == 1) ? std::string("haptic-sim") : "haptic-servo-" + std::to_string(i);
+        servo.escreverRelatorio(arquivo, nome.c_str());
+    }
+    if (arquivo.is_open()) Registro::info(g_logSistema, "Estatísticas do servo salvas em: {}", SERVO_STATS_PATH);
+}
+
+void encerrarHapticos() {
+#if DISABLE_HAPTICS == 0
+    g_dispositivos.parar(); // Nenhuma reconexão depois daqui
+#endif
+    if (g_inicializacaoHaptica.emAndamento()) {
+        // A thread de abertura está travada no driver; fechar o dispositivo por baixo dela seria pior.
+        // Só o fechamento é pulado: broker, gravação e estatísticas encerram normalmente.
+        Registro::aviso(g_logSistema, "Abertura do dispositivo háptico ainda em andamento; encerrando sem fechá-lo.");
+    } else {
+#if DISABLE_HAPTICS == 0
+        Haptics::shutdown();
+#else
+        HapticSimulator::shutdown(); // Encerra a thread servo antes da destruição dos globais
+#endif
+    }
+    g_broker.parar(); // Com o servo parado ou, se ainda rodar, depois de ele sair dos ganchos
+    g_gravador.parar();
+    salvarEstatisticasServo();
+}
+
 // Variável global para a fonte do título (ou passe como parâmetro para executarLoop se preferir)
 ImFont* g_TitleFont = nullptr;
 
-void criarInterface(GLFWwindow* window) {
-    IMGUI_CHECKVERSION(); ImGui::CreateContext(); ImGuiIO& io = ImGui::GetIO(); io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+// Faixas de glifos do atlas; precisam existir até o io.Fonts->Build()
+FaixasGlifos g_faixasGlifos;
+ImVector<ImWchar> g_faixasTitulo;
 
-    std::string robotoPathStr = std::string(FONT_DIR) + ROBOTO_FONT_FILE;
-    std::string iconsPathStr = std::string(FONT_DIR) + ICONS_FONT_FILE;
+// Quebras de linha dos textos dos cards, reaproveitadas entre quadros
+CacheLayoutTexto g_cacheTexto;
 
-    // Fonte Padrão
-    ImFont* fontRoboto = io.Fonts->AddFontFromFileTTF(robotoPathStr.c_str(), 18.0f);
-    if (!fontRoboto) std::cerr << "AVISO: Falha ao carregar fonte Roboto." << std::endl;
+// Perfilador de quadros (overlay alternado com F3)
+PerfiladorQuadro g_perfilador;
+bool g_mostrarPerfilador = false;
 
-    // Fonte para o Título (maior)
-    g_TitleFont = io.Fonts->AddFontFromFileTTF(robotoPathStr.c_str(), 32.0f); // Ex: Roboto tamanho 32 para o título
-    if (!g_TitleFont) {
-        std::cerr << "AVISO: Falha ao carregar fonte do título. Usando fonte padrão para o título." << std::endl;
-        g_TitleFont = fontRoboto; // Fallback para a fonte padrão se a do título falhar
-    }
+// Lido numa thread de trabalho; o atlas é montado depois, na thread da UI
+bool lerArquivo(const std::string& caminho, std::vector<char>& dados) {
+    std::ifstream arquivo(caminho, std::ios::binary | std::ios::ate);
+    if (!arquivo) return false;
+    dados.resize((size_t)arquivo.tellg());
+    arquivo.seekg(0);
+    return (bool)arquivo.read(dados.data(), (std::streamsize)dados.size());
+}
 
-    // Ícones (merge com a fonte padrão ou com a primeira fonte carregada)
-    ImFontConfig icons_config; icons_config.MergeMode = true; icons_config.PixelSnapH = true;
-    // Adicionar os ícones à ÚLTIMA fonte adicionada antes de Build ou à fonte padrão.
-    // Se fontRoboto foi a primeira, e titleFont a segunda, e você quer ícones na fonte principal:
-    // Precisamos garantir que o merge seja com a fonte correta.
-    // Para simplificar, vamos assumir que queremos merge com a primeira (fontRoboto).
-    // Se a fonte principal for a primeira adicionada (index 0), podemos fazer o merge com ela.
-    // Se g_TitleFont foi adicionada depois, e fontRoboto é a default:
-    if (fontRoboto) { // Se a fonte principal carregou
-        io.Fonts->AddFontFromFileTTF(iconsPathStr.c_str(), 16.0f, &icons_config, io.Fonts->GetGlyphRangesDefault()); // Merge com a última fonte adicionada antes desta linha
-    } else { // Se a fonte principal falhou, tenta adicionar os ícones à default que o ImGui usará.
-        ImFontConfig cfg; cfg.MergeMode = true; cfg.PixelSnapH = true;
-        io.Fonts->AddFontDefault(&cfg); // Adiciona ícones à fonte default do ImGui.
-        io.Fonts->AddFontFromFileTTF(iconsPathStr.c_str(), 16.0f, &cfg, io.Fonts->GetGlyphRangesDefault());
-        std::cerr << "AVISO: Falha ao carregar fonte Ícones com a principal. Tentando com default." << std::endl;
-    }
-    // Ou, se você sempre quer os ícones na fonte Roboto principal (que foi carregada primeiro com tamanho 18):
-    // Se fontRoboto != nullptr:
-    // ImGui::PushFont(fontRoboto); // Define temporariamente como a fonte ativa para o merge
-    // io.Fonts->AddFontFromFileTTF(iconsPathStr.c_str(), 16.0f, &icons_config);
-    // ImGui::PopFont();
-
-    io.Fonts->Build(); // CHAME APENAS UMA VEZ APÓS ADICIONAR TODAS AS FONTES
+ArquivosFonte lerArquivosFonte() {
+    EscopoRastreio rastreio("lerArquivosFonte", "inicializacao");
+    EscopoContadores contadores("lerArquivosFonte");
+    ArquivosFonte arquivos;
+    if (!lerArquivo(std::string(FONT_DIR) + ROBOTO_FONT_FILE, arquivos.roboto)) arquivos.roboto.clear();
+    if (!lerArquivo(std::string(FONT_DIR) + ICONS_FONT_FILE, arquivos.icones)) arquivos.icones.clear();
+    return arquivos;
+}
+
+// Contexto, estilo e backends com a fonte embutida do ImGui: nada aqui depende
+// do catálogo nem de arquivos em disco, então o primeiro quadro sai logo
+void criarInterfaceMinima(GLFWwindow* window) {
+    EscopoRastreio rastreio("criarInterfaceMinima", "inicializacao");
+    EscopoContadores contadores("criarInterfaceMinima");
+    IMGUI_CHECKVERSION(); ImGui::CreateContext(); ImGuiIO& io = ImGui::GetIO(); io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    io.Fonts->AddFontDefault(); // Até as fontes do projeto serem aplicadas
 
     ImGuiStyle& style = ImGui::GetStyle();
     style.Colors[ImGuiCol_WindowBg]    = ImVec4(0.12f, 0.14f, 0.17f, 1.00f);
@@ -252,11 +568,196 @@ void criarInterface(GLFWwindow* window) {
     style.Colors[ImGuiCol_FrameBg]     = ImVec4(0.20f, 0.22f, 0.25f, 1.00f);
     style.ItemSpacing = ImVec2(12, 8); style.FrameRounding = 4.0f; style.WindowRounding = 4.0f; style.ChildRounding = 4.0f;
     ImGui_ImplGlfw_InitForOpenGL(window, true); ImGui_ImplOpenGL3_Init("#version 130");
+    g_perfilador.inicializarGpu();
+}
+
+// Acrescenta as fontes do projeto ao atlas. Deve rodar fora de NewFrame/Render e
+// depois que o catálogo foi adotado: só os glifos usados por ele entram no atlas.
+void aplicarFontes(ArquivosFonte arquivos) {
+    EscopoRastreio rastreio("aplicarFontes", "inicializacao");
+    EscopoContadores contadores("aplicarFontes");
+    ImGuiIO& io = ImGui::GetIO();
+    g_arquivosFonte = std::move(arquivos);
+    calcularFaixasGlifos(games, Textos::TODOS, g_faixasGlifos);
+    calcularFaixasTexto(PROJECT_TITLE, g_faixasTitulo);
+
+    ImFontConfig base; base.FontDataOwnedByAtlas = false;
+    std::vector<char>& roboto = g_arquivosFonte.roboto;
+    std::vector<char>& icones = g_arquivosFonte.icones;
+
+    // Fonte Padrão
+    ImFont* fontRoboto = roboto.empty() ? nullptr
+        : io.Fonts->AddFontFromMemoryTTF(roboto.data(), (int)roboto.size(), 18.0f, &base, g_faixasGlifos.texto.Data);
+    if (!fontRoboto) Registro::aviso(g_logInterface, "Falha ao carregar fonte Roboto. Usando a fonte padrão do ImGui.");
+
+    // Ícones: o merge vai para a última fonte adicionada, isto é, a principal
+    // (ou a padrão do ImGui, se a principal falhou)
+    if (g_faixasGlifos.totalIcones == 0) {
+        // Nenhum ícone referenciado: não há o que mesclar
+    } else if (icones.empty()) {
+        Registro::aviso(g_logInterface, "Falha ao carregar fonte Ícones.");
+    } else {
+        ImFontConfig icons_config = base; icons_config.MergeMode = true; icons_config.PixelSnapH = true;
+        io.Fonts->AddFontFromMemoryTTF(icones.data(), (int)icones.size(), 16.0f, &icons_config, g_faixasGlifos.icones.Data);
+    }
+
+    // Fonte para o Título (maior), só com os caracteres do título
+    g_TitleFont = roboto.empty() ? nullptr
+        : io.Fonts->AddFontFromMemoryTTF(roboto.data(), (int)roboto.size(), 32.0f, &base, g_faixasTitulo.Data);
+    if (!g_TitleFont) {
+        Registro::aviso(g_logInterface, "Falha ao carregar fonte do título. Usando fonte padrão para o título.");
+        g_TitleFont = fontRoboto; // Fallback para a fonte padrão se a do título falhar
+    }
+    if (fontRoboto) io.FontDefault = fontRoboto;
+
+    io.Fonts->Build();
+#ifndef IMGUI_HAS_TEXTURES
+    // Sem texturas dinâmicas (ImGui < 1.92) o backend só envia o atlas na criação: recria
+    ImGui_ImplOpenGL3_DestroyFontsTexture(); ImGui_ImplOpenGL3_CreateFontsTexture();
+#endif
+    Registro::depuracao(g_logInterface, "Atlas de fontes: {} glifos de texto, {} ícones, textura {}x{}", g_faixasGlifos.totalTexto, g_faixasGlifos.totalIcones,
+                   io.Fonts->TexWidth, io.Fonts->TexHeight);
+}
+
+// Interface completa de uma vez, para o benchmark (que mede o custo de criá-la)
+void criarInterface(GLFWwindow* window) {
+    EscopoRastreio rastreio("criarInterface", "inicializacao");
+    criarInterfaceMinima(window);
+    aplicarFontes(lerArquivosFonte());
     if (!loadTextureFromFile(BACKGROUND_IMAGE_PATH, &background_texture_id, &background_width, &background_height)) {
-        std::cerr << "AVISO FINAL: Não foi possível carregar e criar a textura de fundo para '" << BACKGROUND_IMAGE_PATH << "'." << std::endl;
+        Registro::aviso(g_logInterface, "Não foi possível carregar e criar a textura de fundo para '{}'.", BACKGROUND_IMAGE_PATH);
+    }
+}
+
+// Catálogo (config + varredura das raízes), arquivos de fonte e imagem de fundo,
+// em paralelo entre si e com a criação da janela. Cada uma acorda a UI ao terminar.
+void iniciarEtapasEmSegundoPlano() {
+    auto acordarUi = [] { g_laco.acordar(); };
+    g_etapaCatalogo.iniciar(carregarCatalogo, acordarUi);
+    g_etapaFontes.iniciar(lerArquivosFonte, acordarUi);
+    g_etapaFundo.iniciar([] { ImagemDecodificada imagem; decodificarImagem(BACKGROUND_IMAGE_PATH, imagem); return imagem; }, acordarUi);
+}
+
+// Recarrega o catálogo em segundo plano. As fontes não são refeitas: glifos
+// de jogos novos fora das faixas já no atlas aparecem só no próximo início.
+void recarregarCatalogo() {
+    if (g_etapaCatalogo.pendente()) { g_laco.rearmarTimer(g_timerRecarga, ESPERA_RECARGA); return; }
+    Registro::info(g_logCatalogo, "Catálogo alterado em disco; recarregando.");
+    g_etapaCatalogo.iniciar(carregarCatalogo, [] { g_laco.acordar(); });
+}
+
+void agendarRecarga() {
+    if (g_timerRecarga < 0) g_timerRecarga = g_laco.criarTimer(ESPERA_RECARGA, std::chrono::nanoseconds(0), recarregarCatalogo);
+    else g_laco.rearmarTimer(g_timerRecarga, ESPERA_RECARGA);
+}
+
+// Um watch sumiu (diretório removido ou desmontado): a próxima adoção refaz todos
+void observacaoPerdida() {
+    g_caminhosObservados.clear();
+    agendarRecarga();
+}
+
+// Observa o games_config.json e as raízes de busca do catálogo adotado.
+void observarCatalogo(const CatalogoCarregado& catalogo) {
+    std::vector<fs::path> caminhos = catalogo.raizes;
+    caminhos.push_back(catalogo.arquivoConfig);
+    if (caminhos == g_caminhosObservados) return;
+    for (int watch : g_observacoesCatalogo) g_laco.removerObservacao(watch);
+    g_observacoesCatalogo.clear();
+    g_caminhosObservados = caminhos;
+
+    // O diretório, não o arquivo: editores salvam gravando outro arquivo e renomeando
+    const std::string nomeConfig = catalogo.arquivoConfig.filename().string();
+    int watch = g_laco.observarCaminho(catalogo.arquivoConfig.parent_path().string(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE,
+        [nomeConfig](const inotify_event& e) {
+            if (e.mask & IN_IGNORED) observacaoPerdida();
+            else if (e.len > 0 && nomeConfig == e.name) agendarRecarga();
+        });
+    if (watch >= 0) g_observacoesCatalogo.push_back(watch);
+    // Jogo instalado, removido ou que ganhou permissão de execução
+    for (const auto& raiz : catalogo.raizes) {
+        std::error_code ec;
+        if (!fs::is_directory(raiz, ec)) continue;
+        watch = g_laco.observarCaminho(raiz.string(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ATTRIB,
+                                       [](const inotify_event& e) { if (e.mask & IN_IGNORED) observacaoPerdida(); else agendarRecarga(); });
+        if (watch >= 0) g_observacoesCatalogo.push_back(watch);
     }
 }
 
+// Chamada pela thread da UI antes de cada NewFrame: adota o que as etapas de
+// inicialização já terminaram. Fontes esperam o catálogo (as faixas dependem dele).
+void adotarEtapasConcluidas() {
+    CatalogoCarregado catalogo;
+    if (g_etapaCatalogo.tomar(catalogo)) {
+        games = std::move(catalogo.jogos);
+        g_catalogoFalhou = !catalogo.ok;
+        g_versaoCatalogo++;
+        popularCatalogo();
+        observarCatalogo(catalogo);
+        Registro::info(g_logCatalogo, "Catálogo pronto em {} ms: {} jogos.", g_etapaCatalogo.ms(), games.size());
+    }
+    ArquivosFonte arquivos;
+    if (!g_etapaCatalogo.pendente() && g_etapaFontes.tomar(arquivos)) {
+        aplicarFontes(std::move(arquivos));
+        Registro::info(g_logInterface, "Fontes lidas em {} ms.", g_etapaFontes.ms());
+    }
+    ImagemDecodificada imagem;
+    if (g_etapaFundo.tomar(imagem)) {
+        if (!imagem.pixels || !criarTexturaDeImagem(imagem, &background_texture_id, &background_width, &background_height)) {
+            Registro::aviso(g_logInterface, "Não foi possível carregar e criar a textura de fundo para '{}'.", BACKGROUND_IMAGE_PATH);
+        } else {
+            Registro::info(g_logInterface, "Imagem de fundo decodificada em {} ms.", g_etapaFundo.ms());
+        }
+    }
+}
+
+// Última amostra do laço servo (real ou simulado), lida sem bloquear
+#if DISABLE_HAPTICS == 0
+constexpr int MAX_DISPOSITIVOS_STATUS = Haptics::MAX_DISPOSITIVOS;
+#else
+constexpr int MAX_DISPOSITIVOS_STATUS = 1; // O simulador é um dispositivo só
+#endif
+
+// Última amostra de cada dispositivo aberto (do mesmo tick, quando possível)
+int lerEstadosHapticos(HapticSample* amostras, int maximo) {
+#if DISABLE_HAPTICS == 0
+    return Haptics::readAlignedStates(amostras, maximo);
+#else
+    return maximo > 0 && HapticSimulator::readState(amostras[0]) ? 1 : 0;
+#endif
+}
+
+// Laço servo rodando: jogos que exigem o dispositivo podem ser iniciados
+bool dispositivoPronto() {
+#if DISABLE_HAPTICS == 0
+    return Haptics::isRunning();
+#else
+    return HapticSimulator::isRunning();
+#endif
+}
+
+// Presença do dispositivo para a barra de status; apenas leituras atômicas
+const char* textoPresencaDispositivo() {
+#if DISABLE_HAPTICS == 0
+    if (Haptics::deviceCount() > 1) {
+        static char varios[32];
+        snprintf(varios, sizeof(varios), Textos::PRESENCA_VARIOS, Haptics::deviceCount());
+        return varios;
+    }
+#endif
+    if (dispositivoPronto()) return Textos::PRESENCA_CONECTADO;
+    switch (g_inicializacaoHaptica.estado()) {
+        case InicializacaoDispositivo::Estado::Conectando:    return Textos::PRESENCA_CONECTANDO;
+        case InicializacaoDispositivo::Estado::TempoEsgotado: return Textos::PRESENCA_SEM_RESPOSTA;
+        case InicializacaoDispositivo::Estado::Falha:         return Textos::PRESENCA_FALHA;
+        default: break;
+    }
+#if DISABLE_HAPTICS == 0
+    if (g_dispositivos.ativo() && g_dispositivos.presenca() == PresencaDispositivo::Conectando) return Textos::PRESENCA_CONECTANDO;
+#endif
+    return Textos::PRESENCA_AUSENTE;
+}
+
 void mostrarBarraStatus() {
     ImGuiViewport* viewport = ImGui::GetMainViewport(); float statusBarHeight = 28.0f;
     ImGui::SetNextWindowPos(ImVec2(viewport->Pos.x, viewport->Pos.y + viewport->Size.y - statusBarHeight));
@@ -271,21 +772,42 @@ void mostrarBarraStatus() {
     localtime_r(&now_time, &timeinfo);
 #endif
     strftime(time_buf, sizeof(time_buf), "%H:%M:%S  %d/%m/%Y", &timeinfo);
-    const char* haptic_status_str = (DISABLE_HAPTICS == 1) ? "Simulação" : "Real";
-    ImGui::Text("Dispositivo: %s | Jogos carregados: %zu | %s", haptic_status_str, games.size(), time_buf);
+    const char* haptic_status_str = (DISABLE_HAPTICS == 1) ? Textos::MODO_SIMULACAO : Textos::MODO_REAL;
+    ImGui::Text(Textos::STATUS_DISPOSITIVO, haptic_status_str, textoPresencaDispositivo(), games.size(), time_buf);
+    HapticSample amostras[MAX_DISPOSITIVOS_STATUS];
+    const int dispositivos = lerEstadosHapticos(amostras, MAX_DISPOSITIVOS_STATUS);
+    for (int i = 0; i < dispositivos; ++i) {
+        const HapticSample& amostra = amostras[i];
+        double forca = std::sqrt(amostra.force.x * amostra.force.x + amostra.force.y * amostra.force.y + amostra.force.z * amostra.force.z);
+        ImGui::SameLine(0.0f, 24.0f);
+        if (dispositivos > 1) { ImGui::Text(Textos::STATUS_HAPTICO_INDICE, i); ImGui::SameLine(); }
+        ImGui::Text(Textos::STATUS_HAPTICO, amostra.position.x * 1000.0, amostra.position.y * 1000.0, amostra.position.z * 1000.0,
+                    amostra.buttons, forca);
+    }
+    const int servos = quantidadeServos();
+    for (int i = 0; i < servos; ++i) {
+        const EstatisticasServo& servo = estatisticasServo(i);
+        if (servo.iteracoes() == 0) continue;
+        ImGui::SameLine(0.0f, 24.0f);
+        if (servos > 1) { ImGui::Text(Textos::STATUS_HAPTICO_INDICE, i); ImGui::SameLine(); }
+        ImGui::Text(Textos::STATUS_SERVO, servo.taxaMedidaHz(), servo.jitterNs() / 1000.0, (unsigned long long)servo.prazosPerdidos());
+    }
+    if (g_broker.clienteConectado()) {
+        ImGui::SameLine(0.0f, 24.0f);
+        ImGui::TextUnformatted(Textos::STATUS_BROKER);
+    }
     ImGui::End();
 }
 
 void mostrarCardJogo(const GameInfo& game) {
     ImGuiStyle& style = ImGui::GetStyle();
-    ImGui::PushID(game.path.string().c_str());
+    ImGui::PushID(game.path.c_str()); // c_str(), não string(): sem cópia a cada quadro
 
-    // --- Dimensões Fixas para o Card ---
-    float cardWidth = 290.0f;
-    float cardHeight = 260.0f; // ALTURA FIXA PARA O CARD. Ajuste este valor!
-        // Aumentei um pouco para dar mais espaço.
+    // --- Dimensões Fixas para o Card (compartilhadas com o layout da grade) ---
+    float cardWidth = CARD_LARGURA;
+    float cardHeight = CARD_ALTURA;
 
-    // Usar o ImGuiCol_ChildBg definido globalmente em criarInterface
+    // Usar o ImGuiCol_ChildBg definido globalmente em criarInterfaceMinima
     ImGui::BeginChild("CardFrame", ImVec2(cardWidth, cardHeight), true, ImGuiWindowFlags_AlwaysUseWindowPadding);
 
     // --- Header (Subject) ---
@@ -293,7 +815,7 @@ void mostrarCardJogo(const GameInfo& game) {
     // Permitir que o título ocupe no máximo 2 linhas de altura
     float titleMaxHeight = ImGui::GetTextLineHeightWithSpacing() * 2.1f;
     ImGui::BeginChild("TitleRegion", ImVec2(0, titleMaxHeight), false, ImGuiWindowFlags_NoScrollbar); // false para sem borda, sem scrollbar
-    ImGui::TextWrapped("%s", game.cfg.subject.c_str());
+    TextoQuebradoCache(g_cacheTexto, "subject", game.cfg.subject);
     ImGui::EndChild(); // TitleRegion
     ImGui::PopStyleColor();
     ImGui::Separator();
@@ -314,15 +836,15 @@ void mostrarCardJogo(const GameInfo& game) {
     // Child para a descrição. Se o texto for maior, ele será cortado ou terá scroll.
     // Adicione ImGuiWindowFlags_AlwaysVerticalScrollbar se quiser scroll explícito.
     ImGui::BeginChild("DescriptionRegion", ImVec2(0, descMaxHeight), false, ImGuiWindowFlags_NoScrollbar);
-    ImGui::TextWrapped("%s", game.cfg.description.c_str());
+    TextoQuebradoCache(g_cacheTexto, "description", game.cfg.description);
     ImGui::EndChild(); // DescriptionRegion
 
     // --- Habilidades (Skills) com Scroll Horizontal ---
     if (!game.cfg.skills.empty()) {
         // A altura da área de tags é fixa
         float actualTagsAreaHeight = ImGui::GetTextLineHeightWithSpacing() + style.FramePadding.y * 2;
-        std::string skillsChildID = "SkillsChild##"; skillsChildID += game.path.string();
-        ImGui::BeginChild(skillsChildID.c_str(), ImVec2(0, actualTagsAreaHeight), false, ImGuiWindowFlags_HorizontalScrollbar);
+        // O PushID do card já torna o ID único
+        ImGui::BeginChild("SkillsChild", ImVec2(0, actualTagsAreaHeight), false, ImGuiWindowFlags_HorizontalScrollbar);
         for (size_t i = 0; i < game.cfg.skills.size(); ++i) {
             if (i > 0) ImGui::SameLine(0.0f, style.ItemSpacing.x); // Adiciona espaçamento entre tags
             ImGui::Tag(game.cfg.skills[i].c_str(), ImVec4(0.26f, 0.59f, 0.98f, 0.7f));
@@ -344,13 +866,20 @@ void mostrarCardJogo(const GameInfo& game) {
     }
     ImGui::Spacing(); // Garante um pequeno espaço antes do botão
 
-    if (ImGui::ButtonCustom("INICIAR", ImVec2(-1.0f, 30.0f))) {
-        std::cout << "Iniciando jogo: " << game.path.string() << std::endl;
-        std::thread([game_path_str = game.path.string()]() {
-            int result = std::system(game_path_str.c_str());
-            if (result != 0) std::cerr << "Erro ao executar o jogo (código: " << result << "): " << game_path_str << std::endl;
-        }).detach();
+    // Jogos hápticos ficam bloqueados enquanto o dispositivo conecta (ou se falhou)
+    // (no benchmark não há dispositivo: o card é medido no estado normal)
+    const bool aguardandoDispositivo = game.cfg.requiresHaptics && !g_modoBench && !dispositivoPronto();
+    ImGui::BeginDisabled(aguardandoDispositivo);
+    if (ImGui::ButtonCustom(Textos::BOTAO_INICIAR, ImVec2(-1.0f, 30.0f))) {
+        const std::string caminho = game.path.string();
+        Registro::info(g_logJogos, "Iniciando jogo: {}", caminho);
+        pid_t pid = Processos::lancarJogo(caminho);
+        auto aoTerminar = [caminho](pid_t p, int status) { Processos::registrarTermino(p, status, caminho); };
+        if (pid > 0 && !g_laco.observarProcesso(pid, aoTerminar, Processos::encerrarRestantes))
+            std::thread(Processos::aguardarTermino, pid, caminho).detach();
     }
+    ImGui::EndDisabled();
+    if (aguardandoDispositivo) ImGui::SetItemTooltip("%s", Textos::INICIAR_AGUARDANDO);
 
     ImGui::EndChild(); // CardFrame
     ImGui::PopID();
@@ -359,20 +888,20 @@ void mostrarCardJogo(const GameInfo& game) {
 void mostrarFiltros(char* filtro_texto, std::string& materiaSelecionada, std::string& habilidadeSelecionada,
                     const std::set<std::string>& todasMaterias, const std::set<std::string>& todasHabilidades) {
     // Este BeginChild (Filtros e Pesquisa) usará o ImGuiCol_ChildBg definido no tema
-    ImGui::Begin("Filtros e Pesquisa", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
-    ImGui::TextUnformatted("Pesquisar por termo:");
-    ImGui::InputTextWithHint("##SearchTerm", "Digite descrição, matéria, etc.", filtro_texto, 128); ImGui::Separator();
+    ImGui::Begin(Textos::JANELA_FILTROS, nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::TextUnformatted(Textos::PESQUISAR);
+    ImGui::InputTextWithHint("##SearchTerm", Textos::PESQUISAR_DICA, filtro_texto, 128); ImGui::Separator();
     if (ImGui::BeginTabBar("FiltrosTabBar", ImGuiTabBarFlags_None)) {
-        if (ImGui::BeginTabItem("Matérias")) {
+        if (ImGui::BeginTabItem(Textos::ABA_MATERIAS)) {
             if (ImGui::BeginListBox("##MateriasListBox", ImVec2(-FLT_MIN, 150))) {
-                if (ImGui::Selectable("Todas Matérias", materiaSelecionada == "Todas")) materiaSelecionada = "Todas";
+                if (ImGui::Selectable(Textos::TODAS_MATERIAS, materiaSelecionada == "Todas")) materiaSelecionada = "Todas";
                 for (const auto& m : todasMaterias) if (ImGui::Selectable(m.c_str(), m == materiaSelecionada)) materiaSelecionada = m;
                 ImGui::EndListBox();
             } ImGui::EndTabItem();
         }
-        if (ImGui::BeginTabItem("Habilidades")) {
+        if (ImGui::BeginTabItem(Textos::ABA_HABILIDADES)) {
             if (ImGui::BeginListBox("##HabilidadesListBox", ImVec2(-FLT_MIN, 150))) {
-                if (ImGui::Selectable("Todas Habilidades", habilidadeSelecionada == "Todas")) habilidadeSelecionada = "Todas";
+                if (ImGui::Selectable(Textos::TODAS_HABILIDADES, habilidadeSelecionada == "Todas")) habilidadeSelecionada = "Todas";
                 for (const auto& h : todasHabilidades) if (ImGui::Selectable(h.c_str(), h == habilidadeSelecionada)) habilidadeSelecionada = h;
                 ImGui::EndListBox();
             } ImGui::EndTabItem();
@@ -381,24 +910,63 @@ void mostrarFiltros(char* filtro_texto, std::string& materiaSelecionada, std::st
 }
 
 // --- Loop Principal ---
-void executarLoop(GLFWwindow* window) {
-    char filtro_texto[128] = {0};
-    std::string materiaSelecionada = "Todas";
-    std::string habilidadeSelecionada = "Todas";
+// Chamado no início de cada quadro com o número do quadro; pode alterar os filtros
+// (usado pelo modo benchmark). Retornar false encerra o loop.
+using RoteiroQuadro = std::function<bool(uint64_t quadro, EstadoFiltros& filtros)>;
+
+void executarLoop(GLFWwindow* window, const RoteiroQuadro& roteiro = nullptr) {
+    EstadoFiltros filtros;
+    char* filtro_texto = filtros.texto;
+    std::string& materiaSelecionada = filtros.materia;
+    std::string& habilidadeSelecionada = filtros.habilidade;
     ImVec4 clear_color_fallback = ImVec4(0.1f, 0.1f, 0.1f, 1.00f);
     float overall_margin = 20.0f; // Margem geral para os painéis
 
-    const char* projectTitle = "Projeto Jardim";
-
-    while (!glfwWindowShouldClose(window) && !emergency_stop) {
-        glfwPollEvents();
+    const char* projectTitle = PROJECT_TITLE;
+
+    // Filtro e grade só são recalculados quando os critérios ou o painel mudam
+    FiltroJogos filtro;
+    GradeCards grade;
+    uint64_t versaoCatalogo = g_versaoCatalogo;
+
+    // Sem X11 (ex.: Wayland) não há descritor da janela para esperar: ~60 Hz
+    const int fdGrafico = descritorServidorGrafico();
+    if (fdGrafico >= 0) g_laco.observarFd(fdGrafico, EPOLLIN, [](uint32_t) {});
+    int quadrosPendentes = QUADROS_APOS_EVENTO;
+
+    for (uint64_t quadro = 0; !glfwWindowShouldClose(window) && !emergency_stop; ++quadro) {
+        if (roteiro && !roteiro(quadro, filtros)) break;
+        // Fora do quadro medido: o tempo dormindo não é custo de quadro. O benchmark,
+        // o perfilador e a digitação (cursor piscando) pedem quadros contínuos.
+        const bool continuo = roteiro || g_mostrarPerfilador || ImGui::GetIO().WantTextInput ||
+                              quadrosPendentes > 0 || eventosGraficosPendentes();
+        // Dormir à espera de eventos não é travamento; o quadro volta a ser vigiado ao acordar
+        Vigia::ocioso();
+        if (g_laco.aguardar(continuo ? 0 : fdGrafico >= 0 ? -1 : 16) > 0) quadrosPendentes = QUADROS_APOS_EVENTO;
+        else if (quadrosPendentes > 0) quadrosPendentes--;
+        Vigia::batimento();
+        g_perfilador.iniciarQuadro();
+        {
+            EscopoFase fase(g_perfilador, FaseQuadro::Eventos);
+            glfwPollEvents();
+        }
+        adotarEtapasConcluidas();
+        if (versaoCatalogo != g_versaoCatalogo) {
+            versaoCatalogo = g_versaoCatalogo;
+            filtro.invalidar();
+            g_cacheTexto.invalidar();
+        }
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
+        if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) g_mostrarPerfilador = !g_mostrarPerfilador;
 
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
 
+        // Descarta as quebras de linha em cache se a janela ou a fonte mudaram
+        g_cacheTexto.iniciarQuadro(ImGui::GetFont(), ImGui::GetIO().DisplaySize);
+
         // Desenhar a imagem de fundo primeiro
         if (background_texture_id != 0) {
             ImGui::GetBackgroundDrawList()->AddImage(
@@ -427,8 +995,15 @@ void executarLoop(GLFWwindow* window) {
         // --- Barra de Menu ---
         float menuBarHeight = 0.0f;
         if (ImGui::BeginMenuBar()) {
-            if (ImGui::BeginMenu("Arquivo")) {
-                if (ImGui::MenuItem("Sair", "Alt+F4")) { emergency_stop = 1; }
+            if (ImGui::BeginMenu(Textos::MENU_ARQUIVO)) {
+                if (ImGui::MenuItem(Textos::MENU_SALVAR_SERVO)) { salvarEstatisticasServo(); }
+                if (ImGui::MenuItem(Textos::MENU_RASTREAMENTO, nullptr, false, Rastreamento::ativo())) { Rastreamento::exportar(g_caminhoRastreamento); }
+                if (ImGui::MenuItem(Textos::MENU_PARADA)) { ParadaEmergencia::acionar(0); }
+                if (ImGui::MenuItem(Textos::MENU_SAIR, "Alt+F4")) { emergency_stop = true; }
+                ImGui::EndMenu();
+            }
+            if (ImGui::BeginMenu(Textos::MENU_EXIBIR)) {
+                ImGui::MenuItem(Textos::MENU_PERFILADOR, "F3", &g_mostrarPerfilador);
                 ImGui::EndMenu();
             }
             menuBarHeight = ImGui::GetFrameHeight(); // Altura da barra de menu
@@ -496,79 +1071,193 @@ void executarLoop(GLFWwindow* window) {
         ImGui::SetCursorPosY(panelsStartY);
 
         ImGui::BeginChild("JogosPane", ImVec2(ImGui::GetContentRegionAvail().x - overall_margin, availablePaneHeight), true, ImGuiWindowFlags_AlwaysUseWindowPadding);
-        ImGui::Text("Jogos Disponíveis"); ImGui::Separator();
-
-        float card_fixed_width_for_layout = 290.0f;
-        int displayed_games_count = 0;
-        int cards_in_current_row = 0;
-        for (const auto& game : games) {
-            bool filtroMateriaOk = (materiaSelecionada == "Todas") || (game.cfg.subject == materiaSelecionada);
-            bool filtroHabilidadeOk = (habilidadeSelecionada == "Todas") || (std::find(game.cfg.skills.begin(), game.cfg.skills.end(), habilidadeSelecionada) != game.cfg.skills.end());
-            std::string lowerFiltro(filtro_texto); std::transform(lowerFiltro.begin(), lowerFiltro.end(), lowerFiltro.begin(), [](unsigned char c){ return std::tolower(c); });
-            std::string lowerDesc(game.cfg.description); std::transform(lowerDesc.begin(), lowerDesc.end(), lowerDesc.begin(), [](unsigned char c){ return std::tolower(c); });
-            std::string lowerSubj(game.cfg.subject); std::transform(lowerSubj.begin(), lowerSubj.end(), lowerSubj.begin(), [](unsigned char c){ return std::tolower(c); });
-            bool filtroTextoOk = (strlen(filtro_texto) == 0) || (lowerDesc.find(lowerFiltro) != std::string::npos) || (lowerSubj.find(lowerFiltro) != std::string::npos);
-
-            if (filtroMateriaOk && filtroHabilidadeOk && filtroTextoOk) {
-                displayed_games_count++;
-                if (cards_in_current_row > 0) {
-                    float lastItemEndX = ImGui::GetItemRectMax().x;
-                    float nextItemStartX = lastItemEndX + style_loop.ItemSpacing.x;
-                    // O GetWindowPos().x aqui se refere ao JogosPane (janela atual do ImGui::BeginChild)
-                    if ((nextItemStartX + card_fixed_width_for_layout) <= (ImGui::GetWindowPos().x + ImGui::GetWindowContentRegionMax().x)) {
-                        ImGui::SameLine();
-                    } else {
-                        cards_in_current_row = 0;
-                    }
-                }
-                mostrarCardJogo(game);
-                cards_in_current_row++;
-            }
+        ImGui::TextUnformatted(Textos::JOGOS_DISPONIVEIS); ImGui::Separator();
+
+        g_perfilador.iniciarFase(FaseQuadro::Filtro);
+        filtro.atualizar(games, filtro_texto, materiaSelecionada, habilidadeSelecionada);
+        const std::vector<size_t>& filtrados = filtro.indices();
+        const LayoutGrade& layout = grade.atualizar(ImGui::GetContentRegionAvail().x, style_loop.ItemSpacing,
+                                                    filtro.geracao(), filtrados.size());
+        g_perfilador.encerrarFase(FaseQuadro::Filtro);
+
+        // Cada card vai direto para a posição calculada; os que estão fora da
+        // área visível do painel nem são submetidos.
+        ImVec2 origemCards = ImGui::GetCursorPos();
+        ImVec2 origemCardsTela = ImGui::GetCursorScreenPos();
+        int displayed_games_count = (int)filtrados.size();
+        g_perfilador.iniciarFase(FaseQuadro::Cards);
+        for (size_t i = 0; i < filtrados.size(); ++i) {
+            const ImVec2& pos = layout.posicoes[i];
+            ImVec2 minTela(origemCardsTela.x + pos.x, origemCardsTela.y + pos.y);
+            if (!ImGui::IsRectVisible(minTela, ImVec2(minTela.x + CARD_LARGURA, minTela.y + CARD_ALTURA))) continue;
+            ImGui::SetCursorPos(ImVec2(origemCards.x + pos.x, origemCards.y + pos.y));
+            mostrarCardJogo(games[filtrados[i]]);
+        }
+        g_perfilador.encerrarFase(FaseQuadro::Cards);
+        // Reserva a área total da grade para a barra de rolagem do painel
+        ImGui::SetCursorPos(origemCards);
+        ImGui::Dummy(layout.tamanhoTotal);
+        if (displayed_games_count == 0) {
+            const char* aviso = g_etapaCatalogo.pendente() ? Textos::CARREGANDO_CATALOGO
+                              : g_catalogoFalhou ? Textos::CATALOGO_FALHOU : Textos::NENHUM_JOGO;
+            ImGui::TextWrapped("%s", aviso);
         }
-        if (displayed_games_count == 0) ImGui::TextWrapped("Nenhum jogo encontrado com os filtros atuais.");
         ImGui::EndChild(); // JogosPane
 
         ImGui::End(); // JanelaPrincipal
 
         mostrarBarraStatus();
+        if (g_mostrarPerfilador) g_perfilador.desenharOverlay(&g_mostrarPerfilador);
 
+        g_perfilador.iniciarGpu();
         glViewport(0, 0, display_w, display_h);
         if (background_texture_id == 0) {
             glClearColor(clear_color_fallback.x * clear_color_fallback.w, clear_color_fallback.y * clear_color_fallback.w, clear_color_fallback.z * clear_color_fallback.w, clear_color_fallback.w);
         }
         glClear(GL_COLOR_BUFFER_BIT);
 
+        g_perfilador.iniciarFase(FaseQuadro::Render);
         ImGui::Render();
+        g_perfilador.encerrarFase(FaseQuadro::Render);
+        g_perfilador.iniciarFase(FaseQuadro::RenderDrawData);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        g_perfilador.encerrarFase(FaseQuadro::RenderDrawData);
+        g_perfilador.encerrarGpu();
+        {
+            EscopoFase fase(g_perfilador, FaseQuadro::Swap);
+            glfwSwapBuffers(window);
+        }
+        g_perfilador.encerrarQuadro();
+        if (quadro == 0) Rastreamento::instante("primeiro quadro", "inicializacao");
+    }
+    if (fdGrafico >= 0) g_laco.removerFd(fdGrafico);
+    // Fora do laço não há batimentos: um encerramento lento (fechar os
+    // dispositivos, esperar threads) não pode ser tomado por travamento
+    Vigia::encerrar();
+}
+
+// --- Modo Benchmark ---
+// Catálogo sintético, roteiro fixo de filtros e pesquisa, janela oculta e sem vsync.
+// O relatório JSON sai em opcoes.saida.
+bool executarBench(GLFWwindow* window, const OpcoesBench& opcoes) {
+    ResultadoBench resultado;
+    std::vector<GameInfo> jogos;
+    bool catalogoOk;
+    {
+        EscopoContadores contadores("carregarCatalogoBench");
+        catalogoOk = carregarCatalogoBench(opcoes, jogos, resultado);
+    }
+    if (!catalogoOk) { Registro::erro(g_logSistema, "Benchmark: catálogo sintético vazio."); return false; }
+    games = std::move(jogos);
+    popularCatalogo();
+
+    auto inicio = std::chrono::steady_clock::now();
+    criarInterface(window);
+    resultado.interfaceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+
+    glfwSwapInterval(0);
+    RoteiroBench roteiro(opcoes, g_availableSubjects, g_availableSkills, resultado);
+    executarLoop(window, [&roteiro, &opcoes](uint64_t quadro, EstadoFiltros& filtros) {
+        if (quadro == (uint64_t)opcoes.aquecimento) g_perfilador.zerarContadores(); // Só os quadros medidos
+        return roteiro.aplicar(quadro, filtros);
+    });
+    resultado.contadoresAtivos = ContadoresCpu::habilitado();
+    resultado.motivoContadores = ContadoresCpu::motivo();
+    if (resultado.contadoresAtivos) {
+        resultado.contadoresQuadro = g_perfilador.contadoresTotais(-1);
+        for (int f = 0; f < PerfiladorQuadro::FASES; ++f)
+            resultado.contadoresFases.emplace_back(PerfiladorQuadro::nomeFase(f), g_perfilador.contadoresTotais(f));
+        resultado.etapasContadores = ContadoresCpu::etapas();
     }
+    if (!escreverRelatorioBench(opcoes, resultado, games.size())) return false;
+    // Quadros sem mudança de critério não podem alocar no heap
+    const uint64_t alocacoesEstaveis = alocacoesEmQuadrosEstaveis(resultado);
+    if (ContadorAlocacoes::ativo() && alocacoesEstaveis > 0) {
+        Registro::erro(g_logSistema, "Benchmark: {} alocações em quadros estáveis (esperado 0).", alocacoesEstaveis);
+        return false;
+    }
+    return true;
 }
 
 // --- Ponto de Entrada ---
 int main(int argc, char** argv) {
-    (void)argc; (void)argv;
-    if (!glfwInit()) { std::cerr << "ERRO CRÍTICO: Falha ao inicializar GLFW!" << std::endl; return EXIT_FAILURE; }
+    // --metrics-scrape: só consulta o launcher em execução, sem abrir janela
+    Metricas::Configuracao metricas;
+    if (!lerOpcoesMetricas(argc, argv, metricas)) return EXIT_FAILURE;
+    if (metricas.raspar) {
+        std::string pagina;
+        if (!Metricas::raspar(metricas, pagina)) return EXIT_FAILURE;
+        std::cout << pagina;
+        return EXIT_SUCCESS;
+    }
+    // Antes de qualquer thread: todas herdam os sinais de parada bloqueados
+    // SIGUSR1 também: bloqueado aqui, é lido pelo laço de eventos (salva rastreamento e estatísticas)
+    if (!g_laco.iniciar()) return EXIT_FAILURE;
+    sigset_t sinaisLaco;
+    sigemptyset(&sinaisLaco);
+    sigaddset(&sinaisLaco, SIGUSR1);
+    g_laco.observarSinais(sinaisLaco, [](const signalfd_siginfo&) {
+        if (Rastreamento::ativo()) Rastreamento::exportar(g_caminhoRastreamento);
+        salvarEstatisticasServo();
+    });
+    if (!ParadaEmergencia::instalar(aoPararEmergencia)) return EXIT_FAILURE;
+    OpcoesBench bench;
+    if (!lerOpcoesBench(argc, argv, bench)) return EXIT_FAILURE;
+    g_modoBench = bench.ativo;
+#if DISABLE_HAPTICS == 1
+    if (!lerOpcoesSimulador(argc, argv, g_configSimulador)) return EXIT_FAILURE;
+#endif
+    lerOpcoesGravacao(argc, argv, g_caminhoGravacao);
+    lerOpcoesTempoReal(argc, argv, g_tempoReal);
+    lerOpcoesRastreamento(argc, argv, g_caminhoRastreamento);
+    Registro::Configuracao registro;
+    if (!lerOpcoesRegistro(argc, argv, registro)) return EXIT_FAILURE;
+    Vigia::Configuracao vigia;
+    if (!lerOpcoesVigia(argc, argv, vigia)) return EXIT_FAILURE;
+    Registro::iniciar(registro);
+    // A inicialização também é vigiada: GLEW, fontes e texturas rodam nesta thread
+    Vigia::iniciar(vigia);
+    // Sem a porta o launcher segue funcionando; o erro fica no log
+    Metricas::iniciarServidor(metricas);
+    // Antes das etapas em segundo plano, que também são medidas
+    if (lerOpcoesContadores(argc, argv)) ContadoresCpu::habilitar();
+    if (!bench.ativo) iniciarEtapasEmSegundoPlano();
+    if (!glfwInit()) { Registro::erro(g_logSistema, "CRÍTICO: Falha ao inicializar GLFW!"); return EXIT_FAILURE; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2); glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (bench.ativo) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Benchmark roda em janela oculta
+    Vigia::batimento("janela");
     GLFWwindow* window = glfwCreateWindow(1280, 720, "Projeto Jardim - Interface Educativa CHAI3D", nullptr, nullptr);
-    if (!window) { std::cerr << "ERRO CRÍTICO: Falha ao criar janela GLFW!" << std::endl; glfwTerminate(); return EXIT_FAILURE; }
+    if (!window) { Registro::erro(g_logSistema, "CRÍTICO: Falha ao criar janela GLFW!"); glfwTerminate(); return EXIT_FAILURE; }
     glfwMakeContextCurrent(window); glfwSwapInterval(1);
     glewExperimental = GL_TRUE; GLenum glewError = glewInit();
-    if (glewError != GLEW_OK) { std::cerr << "ERRO CRÍTICO: Falha ao inicializar GLEW! " << glewGetErrorString(glewError) << std::endl; glfwDestroyWindow(window); glfwTerminate(); return EXIT_FAILURE; }
+    if (glewError != GLEW_OK) { Registro::erro(g_logSistema, "CRÍTICO: Falha ao inicializar GLEW! {}", (const char*)glewGetErrorString(glewError)); glfwDestroyWindow(window); glfwTerminate(); return EXIT_FAILURE; }
     glGetError();
-    if (!inicializarSistema()) { std::cerr << "ERRO CRÍTICO: Falha na inicialização do sistema." << std::endl; glfwDestroyWindow(window); glfwTerminate(); return EXIT_FAILURE; }
-    criarInterface(window);
+    if (bench.ativo) {
+        bool ok = executarBench(window, bench);
+        if (background_texture_id != 0) glDeleteTextures(1, &background_texture_id);
+        g_perfilador.liberarGpu();
+        ImGui_ImplOpenGL3_Shutdown(); ImGui_ImplGlfw_Shutdown(); ImGui::DestroyContext();
+        glfwDestroyWindow(window); glfwTerminate();
+        if (Rastreamento::ativo()) Rastreamento::exportar(g_caminhoRastreamento);
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    // Interface mínima primeiro; o resto chega pelas etapas em segundo plano
+    Vigia::batimento("criarInterfaceMinima");
+    criarInterfaceMinima(window);
+    Vigia::batimento("inicializarSistema");
+    if (!inicializarSistema()) { Registro::erro(g_logSistema, "CRÍTICO: Falha na inicialização do sistema."); encerrarHapticos(); glfwDestroyWindow(window); glfwTerminate(); return EXIT_FAILURE; }
+    // Só acorda a UI; o painel lê a amostra mais recente ao desenhar
+    g_laco.criarTimer(PERIODO_STATUS, PERIODO_STATUS, [] {});
     executarLoop(window);
     if (background_texture_id != 0) glDeleteTextures(1, &background_texture_id);
+    g_perfilador.liberarGpu();
     ImGui_ImplOpenGL3_Shutdown(); ImGui_ImplGlfw_Shutdown(); ImGui::DestroyContext();
     glfwDestroyWindow(window); glfwTerminate();
-#if DISABLE_HAPTICS == 0
-    // Haptics::shutdown();
-#else
-    // HapticSimulator::shutdown();
-#endif
-    std::cout << "Aplicação finalizada." << std::endl;
+    encerrarHapticos();
+    if (Rastreamento::ativo()) Rastreamento::exportar(g_caminhoRastreamento);
+    Registro::info(g_logSistema, "Aplicação finalizada.");
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,391 @@
+#include "metrics.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+Registro::Modulo g_log{"metricas"};
+
+constexpr int MAX_ETAPAS = 64;
+constexpr size_t MAX_REQUISICAO = 4096;
+constexpr int PRAZO_CONEXAO_MS = 1000;   // Um cliente lento não segura o servidor
+const char* const TIPO_CONTEUDO = "text/plain; version=0.0.4; charset=utf-8";
+
+// Constante na inicialização: métricas estáticas de outros .cpp podem se
+// registrar antes de main em qualquer ordem
+std::atomic<Metricas::Metrica*> g_metricas{nullptr};
+
+struct Etapa {
+    std::atomic<const char*> nome{nullptr};   // nullptr = slot livre
+    std::atomic<uint64_t> ns{0};
+};
+Etapa g_etapas[MAX_ETAPAS];
+
+struct Servidor {
+    Metricas::Configuracao config;
+    int fdTcp = -1;
+    int fdUnix = -1;
+    int fdParar = -1;
+    std::thread thread;
+};
+
+Servidor& servidor() {
+    static Servidor s;
+    return s;
+}
+
+void formatarNumero(std::string& saida, double v) {
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof(buf), "%.9g", v);
+    saida.append(buf, (size_t)n);
+}
+
+// Tempo limite de leitura e escrita num socket conectado
+void aplicarPrazo(int fd) {
+    timeval prazo{ PRAZO_CONEXAO_MS / 1000, (PRAZO_CONEXAO_MS % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &prazo, sizeof(prazo));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &prazo, sizeof(prazo));
+}
+
+bool enviarTudo(int fd, const char* dados, size_t tamanho) {
+    while (tamanho > 0) {
+        const ssize_t n = send(fd, dados, tamanho, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        dados += n;
+        tamanho -= (size_t)n;
+    }
+    return true;
+}
+
+void responder(int fd, const char* status, const std::string& corpo) {
+    std::string resposta = "HTTP/1.1 ";
+    resposta += status;
+    resposta += "\r\nContent-Type: ";
+    resposta += TIPO_CONTEUDO;
+    resposta += "\r\nContent-Length: " + std::to_string(corpo.size()) + "\r\nConnection: close\r\n\r\n";
+    resposta += corpo;
+    enviarTudo(fd, resposta.data(), resposta.size());
+}
+
+void atender(int fd) {
+    aplicarPrazo(fd);
+    std::string requisicao;
+    char buf[1024];
+    while (requisicao.find("\r\n\r\n") == std::string::npos && requisicao.size() < MAX_REQUISICAO) {
+        const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return; // Desistiu ou estourou o prazo
+        requisicao.append(buf, (size_t)n);
+    }
+    // Só a linha de requisição importa: "GET /metrics HTTP/1.1"
+    const std::string linha = requisicao.substr(0, requisicao.find("\r\n"));
+    if (linha.compare(0, 4, "GET ") != 0) { responder(fd, "405 Method Not Allowed", "Use GET /metrics\n"); return; }
+    const size_t fimCaminho = linha.find(' ', 4);
+    const std::string caminho = linha.substr(4, fimCaminho == std::string::npos ? std::string::npos : fimCaminho - 4);
+    if (caminho != "/metrics" && caminho != "/") { responder(fd, "404 Not Found", "Use GET /metrics\n"); return; }
+    responder(fd, "200 OK", Metricas::gerarPagina());
+}
+
+void executarServidor() {
+    pthread_setname_np(pthread_self(), "metricas");
+    ParadaEmergencia::prepararThread();
+    Servidor& s = servidor();
+    pollfd fds[3] = { { s.fdParar, POLLIN, 0 }, { s.fdTcp, POLLIN, 0 }, { s.fdUnix, POLLIN, 0 } };
+    for (;;) {
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            Registro::erro(g_log, "Servidor de métricas: poll falhou: {}", std::strerror(errno));
+            return;
+        }
+        if (fds[0].revents) return;
+        for (int i = 1; i < 3; ++i) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            const int cliente = accept4(fds[i].fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (cliente < 0) continue;
+            atender(cliente);
+            close(cliente);
+        }
+    }
+}
+
+int abrirTcp(int porta) {
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    const int sim = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &sim, sizeof(sim));
+    sockaddr_in endereco{};
+    endereco.sin_family = AF_INET;
+    endereco.sin_port = htons((uint16_t)porta);
+    endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Nunca exposto fora da máquina
+    if (bind(fd, (const sockaddr*)&endereco, sizeof(endereco)) < 0 || listen(fd, 4) < 0) {
+        const int erro = errno;
+        close(fd);
+        errno = erro;
+        return -1;
+    }
+    return fd;
+}
+
+bool enderecoUnix(const std::string& caminho, sockaddr_un& endereco) {
+    endereco = sockaddr_un{};
+    endereco.sun_family = AF_UNIX;
+    if (caminho.size() >= sizeof(endereco.sun_path)) { errno = ENAMETOOLONG; return false; }
+    std::memcpy(endereco.sun_path, caminho.c_str(), caminho.size() + 1);
+    return true;
+}
+
+int abrirUnix(const std::string& caminho) {
+    sockaddr_un endereco;
+    if (!enderecoUnix(caminho, endereco)) return -1;
+    // Só um socket pode ser sobra de uma execução anterior; um caminho errado
+    // na configuração não pode apagar um arquivo qualquer
+    struct stat info;
+    if (lstat(caminho.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            Registro::erro(g_log, "Métricas: {} já existe e não é um socket; não será removido.", caminho);
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(caminho.c_str());
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, (const sockaddr*)&endereco, sizeof(endereco)) < 0 || listen(fd, 4) < 0) {
+        const int erro = errno;
+        close(fd);
+        errno = erro;
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+namespace Metricas {
+
+struct ListaMetricas {
+    static void inserir(Metrica* m) {
+        Metrica* cabeca = g_metricas.load(std::memory_order_relaxed);
+        do { m->proxima = cabeca; }
+        while (!g_metricas.compare_exchange_weak(cabeca, m, std::memory_order_release, std::memory_order_relaxed));
+    }
+    static const Metrica* proxima(const Metrica* m) { return m->proxima; }
+};
+
+} // namespace Metricas
+
+void Metricas::Pagina::cabecalho(const char* nome, const char* ajuda, const char* tipo) {
+    conteudo += "# HELP ";
+    conteudo += nome;
+    conteudo += ' ';
+    conteudo += ajuda;
+    conteudo += "\n# TYPE ";
+    conteudo += nome;
+    conteudo += ' ';
+    conteudo += tipo;
+    conteudo += '\n';
+}
+
+void Metricas::Pagina::valor(const char* nome, double v, const char* rotulos) {
+    conteudo += nome;
+    if (rotulos && *rotulos) {
+        conteudo += '{';
+        conteudo += rotulos;
+        conteudo += '}';
+    }
+    conteudo += ' ';
+    formatarNumero(conteudo, v);
+    conteudo += '\n';
+}
+
+void Metricas::Pagina::resumo(const char* nome, const char* ajuda, const HistogramaHdr& histograma) {
+    cabecalho(nome, ajuda, "summary");
+    seriesResumo(nome, histograma, std::string());
+}
+
+void Metricas::Pagina::seriesResumo(const char* nome, const HistogramaHdr& histograma, const std::string& rotulos) {
+    static const struct { double p; const char* rotulo; } QUANTIS[] = {
+        { 50.0, "quantile=\"0.5\"" }, { 90.0, "quantile=\"0.9\"" },
+        { 99.0, "quantile=\"0.99\"" }, { 99.9, "quantile=\"0.999\"" },
+    };
+    const std::string prefixo = rotulos.empty() ? rotulos : rotulos + ",";
+    for (const auto& q : QUANTIS) valor(nome, histograma.percentil(q.p) / 1e9, prefixo + q.rotulo);
+    const uint64_t total = histograma.total();
+    const std::string base = nome;
+    valor((base + "_sum").c_str(), histograma.media() * (double)total / 1e9, rotulos);
+    valor((base + "_count").c_str(), (double)total, rotulos);
+}
+
+std::string Metricas::escaparRotulo(const std::string& valor) {
+    std::string saida;
+    saida.reserve(valor.size());
+    for (char c : valor) {
+        if (c == '\\' || c == '"') { saida += '\\'; saida += c; }
+        else if (c == '\n') saida += "\\n";
+        else saida += c;
+    }
+    return saida;
+}
+
+Metricas::Metrica::Metrica(const char* nome, const char* ajuda) : nome(nome), ajuda(ajuda) {
+    ListaMetricas::inserir(this);
+}
+
+void Metricas::Contador::escrever(Pagina& pagina) const {
+    pagina.cabecalho(nome, ajuda, "counter");
+    pagina.valor(nome, (double)valor.load(std::memory_order_relaxed));
+}
+
+void Metricas::Medidor::escrever(Pagina& pagina) const {
+    pagina.cabecalho(nome, ajuda, "gauge");
+    pagina.valor(nome, valor.load(std::memory_order_relaxed));
+}
+
+void Metricas::Resumo::escrever(Pagina& pagina) const {
+    pagina.resumo(nome, ajuda, histograma);
+}
+
+void Metricas::registrarEtapa(const char* nome, double ms) {
+    const uint64_t ns = (uint64_t)(ms * 1e6);
+    for (Etapa& e : g_etapas) {
+        const char* atual = e.nome.load(std::memory_order_acquire);
+        // Slot livre: tenta tomá-lo; se outra thread ganhou, pode ter sido com o mesmo nome
+        if (!atual && e.nome.compare_exchange_strong(atual, nome, std::memory_order_acq_rel)) atual = nome;
+        if (atual == nome || std::strcmp(atual, nome) == 0) {
+            e.ns.fetch_add(ns, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+std::string Metricas::gerarPagina() {
+    Pagina pagina;
+    for (const Metrica* m = g_metricas.load(std::memory_order_acquire); m; m = ListaMetricas::proxima(m)) m->escrever(pagina);
+
+    bool algumaEtapa = false;
+    for (const Etapa& e : g_etapas) {
+        const char* nome = e.nome.load(std::memory_order_acquire);
+        if (!nome) break; // Slots são ocupados em ordem
+        if (!algumaEtapa) {
+            pagina.cabecalho("jardim_startup_stage_seconds", "Duração das etapas de inicialização (soma, se repetidas).", "gauge");
+            algumaEtapa = true;
+        }
+        pagina.valor("jardim_startup_stage_seconds", e.ns.load(std::memory_order_relaxed) / 1e9,
+                     "stage=\"" + escaparRotulo(nome) + "\"");
+    }
+    return pagina.texto();
+}
+
+bool Metricas::iniciarServidor(const Configuracao& config) {
+    Servidor& s = servidor();
+    if (!config.ativo() || s.thread.joinable()) return true;
+    s.config = config;
+    if (config.porta > 0 && (s.fdTcp = abrirTcp(config.porta)) < 0) {
+        Registro::erro(g_log, "Métricas: não foi possível escutar em 127.0.0.1:{}: {}", config.porta, std::strerror(errno));
+        return false;
+    }
+    if (!config.socket.empty() && (s.fdUnix = abrirUnix(config.socket)) < 0) {
+        Registro::erro(g_log, "Métricas: não foi possível escutar em {}: {}", config.socket, std::strerror(errno));
+        if (s.fdTcp >= 0) { close(s.fdTcp); s.fdTcp = -1; }
+        return false;
+    }
+    s.fdParar = eventfd(0, EFD_CLOEXEC);
+    s.thread = std::thread(executarServidor);
+    static bool registrado = false;
+    if (!registrado) { std::atexit(encerrarServidor); registrado = true; }
+    if (s.fdTcp >= 0) Registro::info(g_log, "Métricas em http://127.0.0.1:{}/metrics", config.porta);
+    if (s.fdUnix >= 0) Registro::info(g_log, "Métricas no socket {}", config.socket);
+    return true;
+}
+
+void Metricas::encerrarServidor() {
+    Servidor& s = servidor();
+    if (!s.thread.joinable()) return;
+    const uint64_t um = 1;
+    ssize_t r = write(s.fdParar, &um, sizeof(um));
+    (void)r;
+    s.thread.join();
+    for (int* fd : { &s.fdTcp, &s.fdUnix, &s.fdParar }) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    if (!s.config.socket.empty()) unlink(s.config.socket.c_str());
+}
+
+bool Metricas::raspar(const Configuracao& config, std::string& corpo) {
+    int fd = -1;
+    if (!config.socket.empty()) {
+        sockaddr_un endereco;
+        if (!enderecoUnix(config.socket, endereco)) return false;
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (const sockaddr*)&endereco, sizeof(endereco)) < 0) { close(fd); fd = -1; }
+    } else if (config.porta > 0) {
+        sockaddr_in endereco{};
+        endereco.sin_family = AF_INET;
+        endereco.sin_port = htons((uint16_t)config.porta);
+        endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (const sockaddr*)&endereco, sizeof(endereco)) < 0) { close(fd); fd = -1; }
+    }
+    if (fd < 0) {
+        std::cerr << "Métricas: sem conexão com o launcher: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    aplicarPrazo(fd);
+    const std::string requisicao = "GET /metrics HTTP/1.0\r\nHost: localhost\r\nAccept: text/plain\r\n\r\n";
+    std::string resposta;
+    if (enviarTudo(fd, requisicao.data(), requisicao.size())) {
+        char buf[4096];
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0 || (n < 0 && errno == EINTR)) {
+            if (n > 0) resposta.append(buf, (size_t)n);
+        }
+    }
+    close(fd);
+    const size_t separador = resposta.find("\r\n\r\n");
+    const std::string status = resposta.substr(0, resposta.find("\r\n"));
+    if (separador == std::string::npos || status.find(" 200 ") == std::string::npos) {
+        std::cerr << "Métricas: resposta inválida: " << (status.empty() ? "(vazia)" : status) << std::endl;
+        return false;
+    }
+    corpo = resposta.substr(separador + 4);
+    return true;
+}
+
+bool lerOpcoesMetricas(int argc, char** argv, Metricas::Configuracao& config) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--metrics-scrape") == 0) config.raspar = true;
+        else if (std::strcmp(argv[i], "--metrics-socket") == 0 && i + 1 < argc) config.socket = argv[++i];
+        else if (std::strcmp(argv[i], "--metrics-port") == 0) {
+            char* fim = nullptr;
+            const long porta = i + 1 < argc ? std::strtol(argv[i + 1], &fim, 10) : -1;
+            if (i + 1 >= argc || *fim != '\0' || porta < 1 || porta > 65535) {
+                std::cerr << "Valor inválido para --metrics-port (1 a 65535)" << std::endl;
+                return false;
+            }
+            config.porta = (int)porta;
+            ++i;
+        }
+    }
+    if (config.raspar && !config.ativo()) {
+        std::cerr << "--metrics-scrape precisa de --metrics-port ou --metrics-socket" << std::endl;
+        return false;
+    }
+    return true;
+}
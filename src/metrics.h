@@ -0,0 +1,126 @@
+// metrics.h
+#pragma once
+#include "servo_stats.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Métricas do launcher no formato de texto do Prometheus, servidas numa porta
+// de loopback ou num socket Unix para o monitoramento da frota de quiosques.
+//
+// Cada métrica é um objeto estático do subsistema que a atualiza; o construtor
+// a encadeia numa lista global sem locks. Atualizar custa um store ou um
+// fetch_add relaxado, sem alocação. A página é montada na thread do servidor,
+// que só lê os atômicos; coletores calculam na hora da coleta o que vem de
+// fora (/proc dos jogos, estatísticas do servo).
+//
+// Nomes em snake_case com prefixo "jardim_", unidades no nome (_seconds,
+// _bytes, _total), como pede a convenção do Prometheus.
+namespace Metricas {
+    struct ListaMetricas;
+
+    // Monta a página; usado pelas métricas e pelos coletores.
+    class Pagina {
+    public:
+        // "# HELP" e "# TYPE" ('tipo': counter, gauge, summary)
+        void cabecalho(const char* nome, const char* ajuda, const char* tipo);
+        // 'rotulos' já formatados, sem chaves: "stage=\"x\"" (ou nullptr)
+        void valor(const char* nome, double v, const char* rotulos = nullptr);
+        void valor(const char* nome, double v, const std::string& rotulos) { valor(nome, v, rotulos.c_str()); }
+        // Quantis 0.5/0.9/0.99/0.999, _sum e _count de um histograma em ns, em segundos
+        void resumo(const char* nome, const char* ajuda, const HistogramaHdr& histograma);
+        // Só as séries, para vários conjuntos de rótulos sob um único cabecalho(..., "summary")
+        void seriesResumo(const char* nome, const HistogramaHdr& histograma, const std::string& rotulos);
+
+        const std::string& texto() const { return conteudo; }
+    private:
+        std::string conteudo;
+    };
+
+    // Aspas, barras e quebras de linha num valor de rótulo.
+    std::string escaparRotulo(const std::string& valor);
+
+    class Metrica {
+    public:
+        Metrica(const char* nome, const char* ajuda);
+        Metrica(const Metrica&) = delete;
+        Metrica& operator=(const Metrica&) = delete;
+        virtual ~Metrica() = default;
+        virtual void escrever(Pagina& pagina) const = 0;
+    protected:
+        const char* nome;
+        const char* ajuda;
+    private:
+        friend struct ListaMetricas;
+        Metrica* proxima = nullptr;
+    };
+
+    // Só cresce. Qualquer thread.
+    class Contador : public Metrica {
+    public:
+        using Metrica::Metrica;
+        void incrementar(uint64_t n = 1) { valor.fetch_add(n, std::memory_order_relaxed); }
+        void escrever(Pagina& pagina) const override;
+    private:
+        std::atomic<uint64_t> valor{0};
+    };
+
+    // Valor instantâneo. Qualquer thread.
+    class Medidor : public Metrica {
+    public:
+        using Metrica::Metrica;
+        void definir(double v) { valor.store(v, std::memory_order_relaxed); }
+        void escrever(Pagina& pagina) const override;
+    private:
+        std::atomic<double> valor{0.0};
+    };
+
+    // Distribuição de durações (HistogramaHdr), exportada como summary em
+    // segundos. Um único escritor, como o histograma.
+    class Resumo : public Metrica {
+    public:
+        using Metrica::Metrica;
+        void registrar(uint64_t duracaoNs) { histograma.registrar(duracaoNs); }
+        void escrever(Pagina& pagina) const override;
+    private:
+        HistogramaHdr histograma;
+    };
+
+    // Calculada na coleta, na thread do servidor: não pode tocar em estado da
+    // UI sem sincronização própria.
+    class Coletor : public Metrica {
+    public:
+        using Funcao = void (*)(Pagina& pagina);
+        explicit Coletor(Funcao funcao) : Metrica(nullptr, nullptr), funcao(funcao) {}
+        void escrever(Pagina& pagina) const override { funcao(pagina); }
+    private:
+        Funcao funcao;
+    };
+
+    // Duração de uma etapa de inicialização (somada se a etapa rodar mais de
+    // uma vez). 'nome' precisa ter vida estática. Qualquer thread.
+    void registrarEtapa(const char* nome, double ms);
+
+    // A página inteira, com todas as métricas registradas.
+    std::string gerarPagina();
+
+    struct Configuracao {
+        int porta = 0;            // 127.0.0.1:porta; 0 = sem TCP
+        std::string socket;       // Caminho do socket Unix; vazio = sem socket
+        bool raspar = false;      // --metrics-scrape: só busca a página e imprime
+        bool ativo() const { return porta > 0 || !socket.empty(); }
+    };
+
+    // Servidor HTTP mínimo (GET /metrics) numa thread própria, que responde
+    // mesmo com a UI travada. Uma conexão por vez, com prazos curtos.
+    bool iniciarServidor(const Configuracao& config);
+    void encerrarServidor();
+
+    // Raspador local para testar o endpoint: busca /metrics do servidor
+    // configurado e devolve o corpo. Retorna false se não houver resposta 200.
+    bool raspar(const Configuracao& config, std::string& corpo);
+}
+
+// Lê --metrics-port N, --metrics-socket caminho e --metrics-scrape.
+// Retorna false se um valor for inválido.
+bool lerOpcoesMetricas(int argc, char** argv, Metricas::Configuracao& config);
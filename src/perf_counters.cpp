@@ -0,0 +1,216 @@
+#include "perf_counters.h"
+#include "logger.h"
+#include "metrics.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <mutex>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+Registro::Modulo g_log{"contadores"};
+
+constexpr int MAX_CONTADORES = 4;
+
+struct Evento {
+    uint64_t config;
+    uint32_t bit;
+};
+
+// Ciclos lidera o grupo: os membros são agendados juntos e lidos num único read()
+const Evento EVENTOS[MAX_CONTADORES] = {
+    { PERF_COUNT_HW_CPU_CYCLES,    ContadoresCpu::CICLOS },
+    { PERF_COUNT_HW_INSTRUCTIONS,  ContadoresCpu::INSTRUCOES },
+    { PERF_COUNT_HW_CACHE_MISSES,  ContadoresCpu::FALTAS_CACHE },
+    { PERF_COUNT_HW_BRANCH_MISSES, ContadoresCpu::ERROS_DESVIO },
+};
+
+std::atomic<bool> g_habilitado{false};
+uint32_t g_disponiveis = 0;
+std::string g_motivo = "desativados (use --perf-counters)";
+
+std::mutex g_mutexEtapas;
+std::vector<ContadoresCpu::Etapa> g_etapas;
+
+int abrirEvento(uint64_t config, int lider) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = lider < 0 ? 1 : 0;  // O grupo é ligado de uma vez pelo líder
+    attr.exclude_kernel = 1;            // Só espaço de usuário: permitido com paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0 /* esta thread */, -1, lider, PERF_FLAG_FD_CLOEXEC);
+}
+
+std::string explicarFalha(int erro) {
+    std::string texto = std::strerror(erro);
+    if (erro == EACCES || erro == EPERM) {
+        std::ifstream arquivo("/proc/sys/kernel/perf_event_paranoid");
+        int paranoid = 0;
+        if (arquivo >> paranoid)
+            texto += " (perf_event_paranoid = " + std::to_string(paranoid) + "; precisa de <= 2 ou CAP_PERFMON)";
+    } else if (erro == ENOENT || erro == EOPNOTSUPP) {
+        texto += " (CPU ou máquina virtual sem contadores de hardware)";
+    }
+    return texto;
+}
+
+// Grupo de contadores de uma thread; fechado quando a thread termina
+class GrupoThread {
+public:
+    ~GrupoThread() { fechar(); }
+
+    bool abrir(int& erro) {
+        for (int i = 0; i < MAX_CONTADORES; ++i) {
+            int fd = abrirEvento(EVENTOS[i].config, lider());
+            if (fd < 0) {
+                if (i == 0) { erro = errno; return false; }
+                continue; // Membro opcional ausente: segue sem ele
+            }
+            fds[quantidade] = fd;
+            bits[quantidade] = EVENTOS[i].bit;
+            quantidade++;
+            disponiveis |= EVENTOS[i].bit;
+        }
+        ioctl(lider(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(lider(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+    }
+
+    bool ler(AmostraContadores& amostra) const {
+        // { nr, time_enabled, time_running, valores[nr] }
+        uint64_t buffer[3 + MAX_CONTADORES];
+        if (quantidade == 0 || read(lider(), buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t))) return false;
+        const uint64_t habilitado = buffer[1], rodando = buffer[2];
+        // Com mais eventos que contadores físicos o kernel multiplexa: extrapola
+        const double escala = rodando > 0 && rodando < habilitado ? (double)habilitado / rodando : 1.0;
+        amostra = AmostraContadores();
+        for (int i = 0; i < quantidade && i < (int)buffer[0]; ++i) {
+            const uint64_t v = (uint64_t)(buffer[3 + i] * escala);
+            switch (bits[i]) {
+                case ContadoresCpu::CICLOS:       amostra.ciclos = v; break;
+                case ContadoresCpu::INSTRUCOES:   amostra.instrucoes = v; break;
+                case ContadoresCpu::FALTAS_CACHE: amostra.faltasCache = v; break;
+                case ContadoresCpu::ERROS_DESVIO: amostra.errosDesvio = v; break;
+            }
+        }
+        return true;
+    }
+
+    void fechar() {
+        for (int i = 0; i < quantidade; ++i) close(fds[i]);
+        quantidade = 0;
+    }
+
+    bool aberto() const { return quantidade > 0; }
+    uint32_t disponiveis = 0;
+
+private:
+    int lider() const { return quantidade > 0 ? fds[0] : -1; }
+
+    int fds[MAX_CONTADORES] = {};
+    uint32_t bits[MAX_CONTADORES] = {};
+    int quantidade = 0;
+};
+
+struct EstadoThread {
+    GrupoThread grupo;
+    bool tentou = false;
+};
+
+EstadoThread& estadoThread() {
+    thread_local EstadoThread estado;
+    return estado;
+}
+
+uint64_t agoraNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+bool ContadoresCpu::habilitar() {
+    if (g_habilitado.load()) return true;
+    EstadoThread& estado = estadoThread();
+    estado.tentou = true;
+    int erro = 0;
+    if (!estado.grupo.abrir(erro)) {
+        g_motivo = explicarFalha(erro);
+        Registro::aviso(g_log, "Contadores de hardware indisponíveis: {}", g_motivo);
+        return false;
+    }
+    g_disponiveis = estado.grupo.disponiveis;
+    if (!(g_disponiveis & INSTRUCOES)) {
+        estado.grupo.fechar();
+        g_motivo = "sem contador de instruções";
+        Registro::aviso(g_log, "Contadores de hardware indisponíveis: {}", g_motivo);
+        return false;
+    }
+    g_motivo.clear();
+    g_habilitado.store(true);
+    Registro::info(g_log, "Contadores de hardware ativos: ciclos, instruções{}{}",
+                   (g_disponiveis & FALTAS_CACHE) ? ", faltas de cache" : "",
+                   (g_disponiveis & ERROS_DESVIO) ? ", desvios mal previstos" : "");
+    return true;
+}
+
+bool ContadoresCpu::habilitado() {
+    return g_habilitado.load(std::memory_order_relaxed);
+}
+
+uint32_t ContadoresCpu::disponiveis() {
+    return g_disponiveis;
+}
+
+const std::string& ContadoresCpu::motivo() {
+    return g_motivo;
+}
+
+bool ContadoresCpu::ler(AmostraContadores& amostra) {
+    if (!habilitado()) return false;
+    EstadoThread& estado = estadoThread();
+    if (!estado.tentou) {
+        estado.tentou = true;
+        int erro = 0;
+        if (!estado.grupo.abrir(erro)) Registro::aviso(g_log, "Contadores indisponíveis nesta thread: {}", std::strerror(erro));
+    }
+    return estado.grupo.ler(amostra);
+}
+
+std::vector<ContadoresCpu::Etapa> ContadoresCpu::etapas() {
+    std::lock_guard<std::mutex> trava(g_mutexEtapas);
+    return g_etapas;
+}
+
+EscopoContadores::EscopoContadores(const char* nome)
+    : nome(nome), ativo(false), inicioNs(agoraNs()) {
+    // No corpo: 'inicio' só está construído depois da lista de inicialização
+    ativo = ContadoresCpu::ler(inicio);
+}
+
+EscopoContadores::~EscopoContadores() {
+    const double ms = (agoraNs() - inicioNs) / 1.0e6;
+    Metricas::registrarEtapa(nome, ms);
+    AmostraContadores fim;
+    if (!ativo || !ContadoresCpu::ler(fim)) return;
+    ContadoresCpu::Etapa etapa{ nome, ms, fim - inicio };
+    std::lock_guard<std::mutex> trava(g_mutexEtapas);
+    g_etapas.push_back(etapa);
+}
+
+bool lerOpcoesContadores(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--perf-counters") == 0) return true;
+    }
+    return false;
+}
@@ -0,0 +1,75 @@
+// perf_counters.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Contadores de hardware (perf_event_open) da thread atual: ciclos,
+// instruções, faltas de cache e desvios mal previstos. Explicam o "porquê" dos
+// tempos do perfilador (IPC baixo, cache pequena das máquinas do laboratório).
+//
+// Opcional (--perf-counters). Cada thread abre o próprio grupo na primeira
+// leitura, só em espaço de usuário (exclude_kernel), o que basta com
+// perf_event_paranoid <= 2. Se o kernel negar ou a CPU (ou VM) não tiver os
+// eventos, tudo continua funcionando sem contadores e o motivo é informado.
+struct AmostraContadores {
+    uint64_t ciclos = 0;
+    uint64_t instrucoes = 0;
+    uint64_t faltasCache = 0;   // PERF_COUNT_HW_CACHE_MISSES (último nível)
+    uint64_t errosDesvio = 0;   // PERF_COUNT_HW_BRANCH_MISSES
+
+    AmostraContadores& operator+=(const AmostraContadores& o) {
+        ciclos += o.ciclos; instrucoes += o.instrucoes; faltasCache += o.faltasCache; errosDesvio += o.errosDesvio;
+        return *this;
+    }
+    AmostraContadores operator-(const AmostraContadores& o) const {
+        return { ciclos - o.ciclos, instrucoes - o.instrucoes, faltasCache - o.faltasCache, errosDesvio - o.errosDesvio };
+    }
+
+    double ipc() const { return ciclos ? (double)instrucoes / ciclos : 0.0; }
+    // Por mil instruções (MPKI): comparável entre fases de tamanhos diferentes
+    double faltasCacheMpki() const { return instrucoes ? faltasCache * 1000.0 / instrucoes : 0.0; }
+    double errosDesvioMpki() const { return instrucoes ? errosDesvio * 1000.0 / instrucoes : 0.0; }
+};
+
+namespace ContadoresCpu {
+    // Bits de disponiveis(): um contador ausente fica em zero nas amostras
+    enum : uint32_t { CICLOS = 1, INSTRUCOES = 2, FALTAS_CACHE = 4, ERROS_DESVIO = 8 };
+
+    // Testa o acesso abrindo um grupo nesta thread. Retorna false (com motivo())
+    // se não houver ao menos ciclos e instruções.
+    bool habilitar();
+    bool habilitado();
+    uint32_t disponiveis();
+    const std::string& motivo();
+
+    // Valores acumulados da thread atual (abre o grupo dela na primeira chamada).
+    // Uma única chamada read() por leitura. false se desabilitado ou indisponível.
+    bool ler(AmostraContadores& amostra);
+
+    // Etapas de inicialização medidas com EscopoContadores, de qualquer thread
+    struct Etapa {
+        const char* nome;
+        double ms;
+        AmostraContadores contadores;
+    };
+    std::vector<Etapa> etapas();
+}
+
+// Mede o escopo atual na thread atual e o registra como etapa de inicialização.
+// A duração sempre vai para as métricas; sem contadores habilitados, é só isso.
+class EscopoContadores {
+public:
+    explicit EscopoContadores(const char* nome);
+    ~EscopoContadores();
+    EscopoContadores(const EscopoContadores&) = delete;
+    EscopoContadores& operator=(const EscopoContadores&) = delete;
+private:
+    const char* nome;
+    bool ativo;
+    uint64_t inicioNs = 0;
+    AmostraContadores inicio;
+};
+
+// Lê --perf-counters.
+bool lerOpcoesContadores(int argc, char** argv);
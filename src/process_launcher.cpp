@@ -0,0 +1,181 @@
+#include "process_launcher.h"
+#include "logger.h"
+#include "metrics.h"
+#include "trace.h"
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+
+Registro::Modulo g_log{"jogos"};
+
+// Grupos (pgid == pid do jogo) em execução; 0 = slot livre
+std::atomic<pid_t> g_grupos[Processos::MAX_JOGOS];
+
+static_assert(std::atomic<pid_t>::is_always_lock_free, "O registro é lido dentro de tratadores de sinal");
+
+Metricas::Contador g_metricaLancados{"jardim_games_launched_total", "Jogos lançados com sucesso."};
+Metricas::Contador g_metricaFalhas{"jardim_game_launch_failures_total", "Lançamentos de jogo que falharam no posix_spawn."};
+// Só a thread da UI lança jogos: escritor único do histograma
+Metricas::Resumo g_metricaLatencia{"jardim_game_launch_seconds", "Latência do lançamento de um jogo (posix_spawn até o exec)."};
+
+struct AmostraJogo {
+    pid_t pid;
+    std::string nome;
+    double cpuSegundos;
+    double residenteBytes;
+};
+
+// utime, stime e rss de /proc/<pid>/stat (só o processo líder do grupo)
+bool lerProcesso(pid_t pid, AmostraJogo& amostra) {
+    std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    if (!std::getline(in, stat)) return false;
+    // "pid (nome) estado campo4 ...": o nome pode conter espaços e parênteses
+    const size_t abre = stat.find('('), fecha = stat.rfind(')');
+    if (abre == std::string::npos || fecha == std::string::npos || fecha < abre) return false;
+    unsigned long utime = 0, stime = 0;
+    long rss = 0;
+    // Campos 3 em diante; utime e stime são o 14 e o 15, rss o 24
+    if (std::sscanf(stat.c_str() + fecha + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %*d %*d %*u %*u %ld",
+                    &utime, &stime, &rss) != 3) return false;
+    static const double TICKS = (double)sysconf(_SC_CLK_TCK);
+    static const double PAGINA = (double)sysconf(_SC_PAGESIZE);
+    amostra.pid = pid;
+    amostra.nome = stat.substr(abre + 1, fecha - abre - 1);
+    amostra.cpuSegundos = (utime + stime) / TICKS;
+    amostra.residenteBytes = rss * PAGINA;
+    return true;
+}
+
+void coletarJogos(Metricas::Pagina& pagina) {
+    std::vector<AmostraJogo> amostras;
+    for (auto& slot : g_grupos) {
+        AmostraJogo amostra;
+        const pid_t pid = slot.load(std::memory_order_relaxed);
+        if (pid > 0 && lerProcesso(pid, amostra)) amostras.push_back(std::move(amostra));
+    }
+    pagina.cabecalho("jardim_games_running", "Jogos em execução.", "gauge");
+    pagina.valor("jardim_games_running", (double)Processos::jogosAtivos());
+    if (!amostras.empty()) {
+        pagina.cabecalho("jardim_game_cpu_seconds_total", "CPU (usuário + sistema) de cada jogo em execução.", "counter");
+        for (const auto& a : amostras)
+            pagina.valor("jardim_game_cpu_seconds_total", a.cpuSegundos,
+                         "pid=\"" + std::to_string(a.pid) + "\",game=\"" + Metricas::escaparRotulo(a.nome) + "\"");
+        pagina.cabecalho("jardim_game_resident_bytes", "Memória residente de cada jogo em execução.", "gauge");
+        for (const auto& a : amostras)
+            pagina.valor("jardim_game_resident_bytes", a.residenteBytes,
+                         "pid=\"" + std::to_string(a.pid) + "\",game=\"" + Metricas::escaparRotulo(a.nome) + "\"");
+    }
+    // Jogos que já terminaram e foram colhidos
+    rusage filhos{};
+    getrusage(RUSAGE_CHILDREN, &filhos);
+    const double cpu = filhos.ru_utime.tv_sec + filhos.ru_utime.tv_usec / 1e6 + filhos.ru_stime.tv_sec + filhos.ru_stime.tv_usec / 1e6;
+    pagina.cabecalho("jardim_exited_games_cpu_seconds_total", "CPU somada dos jogos que já terminaram.", "counter");
+    pagina.valor("jardim_exited_games_cpu_seconds_total", cpu);
+    pagina.cabecalho("jardim_exited_games_max_resident_bytes", "Maior memória residente entre os jogos que já terminaram.", "gauge");
+    pagina.valor("jardim_exited_games_max_resident_bytes", filhos.ru_maxrss * 1024.0);
+}
+
+Metricas::Coletor g_coletorJogos{coletarJogos};
+
+bool registrar(pid_t pid) {
+    for (auto& slot : g_grupos) {
+        pid_t vazio = 0;
+        if (slot.compare_exchange_strong(vazio, pid)) return true;
+    }
+    return false;
+}
+
+void remover(pid_t pid) {
+    for (auto& slot : g_grupos) {
+        pid_t atual = pid;
+        slot.compare_exchange_strong(atual, 0);
+    }
+}
+
+} // namespace
+
+void Processos::encerrarRestantes(pid_t pid) {
+    // O zumbi também pertence ao grupo: killpg só falha se o grupo já não existe
+    killpg(pid, SIGTERM);
+}
+
+void Processos::registrarTermino(pid_t pid, int status, const std::string& caminho) {
+    remover(pid);
+    Rastreamento::instante("jogo terminou", "jogos", caminho.c_str());
+    if (WIFSIGNALED(status)) Registro::aviso(g_log, "Jogo terminado pelo sinal {}: {}", WTERMSIG(status), caminho);
+    else if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+        Registro::erro(g_log, "Erro ao executar o jogo (código: {}): {}", WEXITSTATUS(status), caminho);
+    else Registro::info(g_log, "Jogo terminou: {}", caminho);
+}
+
+void Processos::aguardarTermino(pid_t pid, std::string caminho) {
+    // Espera sem colher (WNOWAIT): o grupo ainda tem dono quando é sinalizado
+    siginfo_t info{};
+    int r;
+    while ((r = waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT)) < 0 && errno == EINTR) {}
+    if (r == 0) encerrarRestantes(pid);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    registrarTermino(pid, status, caminho);
+}
+
+pid_t Processos::lancarJogo(const std::string& caminho) {
+    EscopoRastreio rastreio("lancarJogo", "jogos", caminho.c_str());
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    // Novo grupo (pgid = pid do filho); sinais desbloqueados e com ação padrão, já que o
+    // launcher bloqueia SIGINT/SIGTERM para tratá-los via signalfd
+    sigset_t vazio, padrao;
+    sigemptyset(&vazio);
+    sigemptyset(&padrao);
+    sigaddset(&padrao, SIGINT);
+    sigaddset(&padrao, SIGTERM);
+    sigaddset(&padrao, SIGHUP);
+    sigaddset(&padrao, SIGQUIT);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setsigmask(&attr, &vazio);
+    posix_spawnattr_setsigdefault(&attr, &padrao);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = -1;
+    char* argv[] = { const_cast<char*>(caminho.c_str()), nullptr };
+    const uint64_t inicio = Rastreamento::agoraNs();
+    int r = posix_spawn(&pid, caminho.c_str(), nullptr, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (r != 0) {
+        g_metricaFalhas.incrementar();
+        Registro::erro(g_log, "Erro ao executar o jogo ({}): {}", std::strerror(r), caminho);
+        return -1;
+    }
+    g_metricaLatencia.registrar(Rastreamento::agoraNs() - inicio);
+    g_metricaLancados.incrementar();
+    if (!registrar(pid)) Registro::aviso(g_log, "Limite de {} jogos simultâneos; {} não será parado pela emergência.", MAX_JOGOS, caminho);
+    return pid;
+}
+
+int Processos::sinalizarTodos(int sinal) {
+    int n = 0;
+    for (auto& slot : g_grupos) {
+        pid_t pgid = slot.load();
+        if (pgid > 0 && killpg(pgid, sinal) == 0) n++;
+    }
+    return n;
+}
+
+int Processos::jogosAtivos() {
+    int n = 0;
+    for (auto& slot : g_grupos) n += slot.load(std::memory_order_relaxed) > 0;
+    return n;
+}
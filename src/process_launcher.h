@@ -0,0 +1,32 @@
+// process_launcher.h
+#pragma once
+#include <string>
+#include <sys/types.h>
+
+// Lançamento dos jogos, cada um no próprio grupo de processos, para que a
+// parada de emergência possa terminar o jogo e tudo o que ele criou.
+namespace Processos {
+    constexpr int MAX_JOGOS = 16;
+
+    // Lança o executável (sem shell) num novo grupo de processos, com máscara de
+    // sinais e tratadores padrão. Retorna o pid, ou -1 em caso de erro. Quem lança
+    // colhe o filho (pidfd no laço de eventos) e chama registrarTermino.
+    pid_t lancarJogo(const std::string& caminho);
+
+    // O líder terminou e ainda não foi colhido: como zumbi ele mantém o pgid
+    // reservado. Termina (SIGTERM) o que restou do grupo, que depois da colheita
+    // sairia do registro e ficaria fora do alcance da parada de emergência.
+    void encerrarRestantes(pid_t pid);
+
+    // Remove o grupo do registro e informa como o jogo terminou.
+    void registrarTermino(pid_t pid, int status, const std::string& caminho);
+
+    // Alternativa sem pidfd (kernel < 5.3): uma thread bloqueada em waitpid.
+    void aguardarTermino(pid_t pid, std::string caminho);
+
+    // Envia o sinal a todos os grupos de jogos registrados. Async-signal-safe:
+    // só lê o registro atômico e chama killpg. Retorna quantos grupos receberam.
+    int sinalizarTodos(int sinal);
+
+    int jogosAtivos();
+}
@@ -0,0 +1,125 @@
+#include "realtime.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+// Layout de struct sched_attr do kernel (a glibc só a expõe a partir da 2.41)
+struct AtributosEscalonamento {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+constexpr int PRIORIDADE_FIFO_PADRAO = 80;
+constexpr size_t PILHA_PRE_FALTADA = 256 * 1024;
+
+void acrescentar(std::string& detalhes, const char* medida, int erro) {
+    if (!detalhes.empty()) detalhes += "; ";
+    detalhes += medida;
+    detalhes += ": ";
+    detalhes += std::strerror(erro);
+}
+
+bool tentarDeadline(double taxaHz, int& erro) {
+    const uint64_t periodo = (uint64_t)(1.0e9 / taxaHz);
+    AtributosEscalonamento attr{};
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = periodo / 2;
+    attr.sched_deadline = periodo;
+    attr.sched_period = periodo;
+    if (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) return true;
+    erro = errno;
+    return false;
+}
+
+// Toca a pilha que o laço pode usar, para que as faltas de página aconteçam agora
+__attribute__((noinline)) void preFaltarPilha() {
+    volatile unsigned char pilha[PILHA_PRE_FALTADA];
+    for (size_t i = 0; i < sizeof(pilha); i += 4096) pilha[i] = 0;
+}
+
+} // namespace
+
+TempoReal::RelatorioProcesso TempoReal::prepararProcesso(size_t reservaHeapBytes) {
+    RelatorioProcesso r;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) r.memoriaTravada = true;
+    else acrescentar(r.detalhes, "mlockall", errno);
+
+    // O heap nunca volta ao sistema nem usa mmap: a reserva tocada agora continua residente
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (unsigned char* reserva = static_cast<unsigned char*>(std::malloc(reservaHeapBytes))) {
+        const long pagina = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < reservaHeapBytes; i += (size_t)pagina) reserva[i] = 0;
+        std::free(reserva);
+        r.heapPreFaltado = true;
+    }
+    return r;
+}
+
+TempoReal::RelatorioThread TempoReal::prepararThread(int nucleo, int prioridadeFifo, bool tempoReal, double taxaHz) {
+    RelatorioThread r;
+    int erro = 0;
+    if (tempoReal && tentarDeadline(taxaHz, erro)) {
+        r.politica = Politica::Deadline;
+    } else {
+        if (tempoReal) acrescentar(r.detalhes, "SCHED_DEADLINE", erro);
+        if (tempoReal && prioridadeFifo <= 0) prioridadeFifo = PRIORIDADE_FIFO_PADRAO;
+        if (prioridadeFifo > 0) {
+            sched_param param{};
+            param.sched_priority = prioridadeFifo;
+            int e = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (e == 0) r.politica = Politica::Fifo;
+            else acrescentar(r.detalhes, "SCHED_FIFO", e);
+        }
+    }
+
+    if (nucleo >= 0 && r.politica != Politica::Deadline) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(nucleo, &cpus);
+        int e = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (e == 0) r.afinidade = true;
+        else acrescentar(r.detalhes, "afinidade", e);
+    }
+
+    if (tempoReal) {
+        preFaltarPilha();
+        r.pilhaPreFaltada = true;
+    }
+    return r;
+}
+
+const char* TempoReal::nomePolitica(Politica politica) {
+    switch (politica) {
+    case Politica::Normal: return "SCHED_OTHER";
+    case Politica::Fifo: return "SCHED_FIFO";
+    case Politica::Deadline: return "SCHED_DEADLINE";
+    }
+    return "?";
+}
+
+void lerOpcoesTempoReal(int argc, char** argv, bool& tempoReal) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--realtime") == 0) tempoReal = true;
+    }
+}
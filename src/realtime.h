@@ -0,0 +1,40 @@
+// realtime.h
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Higiene de tempo real para o caminho háptico (modo opcional, --realtime).
+//
+// Cada medida é tentada e o resultado é relatado; nenhuma falha impede o
+// programa de rodar — sem privilégios (CAP_SYS_NICE, CAP_IPC_LOCK ou limites
+// rtprio/memlock) o servo continua na política normal.
+namespace TempoReal {
+    enum class Politica { Normal, Fifo, Deadline };
+
+    struct RelatorioProcesso {
+        bool memoriaTravada = false;  // mlockall(MCL_CURRENT | MCL_FUTURE)
+        bool heapPreFaltado = false;  // Reserva de heap tocada e mantida (sem trim/mmap)
+        std::string detalhes;
+    };
+
+    struct RelatorioThread {
+        Politica politica = Politica::Normal;
+        bool afinidade = false;
+        bool pilhaPreFaltada = false;
+        std::string detalhes;
+    };
+
+    // Deve ser chamada antes de criar as threads servo.
+    RelatorioProcesso prepararProcesso(size_t reservaHeapBytes = 8u << 20);
+
+    // Chamada pela própria thread servo antes do laço. Com tempoReal tenta
+    // SCHED_DEADLINE (orçamento de metade do período) e depois SCHED_FIFO;
+    // sem tempoReal só aplica prioridadeFifo, se pedida. SCHED_DEADLINE exige
+    // afinidade com todos os núcleos, então nesse caso o núcleo é ignorado.
+    RelatorioThread prepararThread(int nucleo, int prioridadeFifo, bool tempoReal, double taxaHz);
+
+    const char* nomePolitica(Politica politica);
+}
+
+// Lê --realtime.
+void lerOpcoesTempoReal(int argc, char** argv, bool& tempoReal);
@@ -0,0 +1,91 @@
+// servo_hooks.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "haptic_types.h"
+
+// Pontos de extensão da thread servo, compartilhados pelo dispositivo real e
+// pelo simulado: observadores recebem cada amostra publicada (broker, gravador)
+// e uma fonte de força externa pode substituir a força local de setForce.
+//
+// Tudo é ponteiro de função + contexto em slots atômicos de tamanho fixo: a
+// thread servo nunca trava, aloca ou percorre listas dinâmicas. Depois de
+// remover um gancho, aguardarQuiescencia() garante que a thread servo não está
+// mais dentro dele; só então o contexto pode ser liberado.
+class GanchosServo {
+public:
+    static constexpr int MAX_OBSERVADORES = 4;
+    using Observador = void (*)(void* contexto, const HapticSample& amostra);
+    // Retorna true e preenche forca quando a fonte tem um comando válido para agora.
+    using FonteForca = bool (*)(void* contexto, uint64_t agoraNs, HapticVec3& forca);
+
+    bool adicionarObservador(Observador funcao, void* contexto) {
+        for (auto& slot : observadores) {
+            Observador vazio = nullptr;
+            if (slot.funcao.load(std::memory_order_relaxed) != nullptr) continue;
+            slot.contexto.store(contexto, std::memory_order_relaxed);
+            if (slot.funcao.compare_exchange_strong(vazio, funcao)) return true;
+        }
+        return false;
+    }
+
+    void removerObservador(Observador funcao) {
+        for (auto& slot : observadores) {
+            Observador atual = funcao;
+            slot.funcao.compare_exchange_strong(atual, nullptr);
+        }
+    }
+
+    void definirFonteForca(FonteForca funcao, void* contexto) {
+        fonte.funcao.store(nullptr);
+        fonte.contexto.store(contexto, std::memory_order_relaxed);
+        fonte.funcao.store(funcao);
+    }
+
+    // Espera a thread servo sair de uma chamada de gancho em andamento, se
+    // houver. Chamadas que começarem depois já veem os ganchos removidos antes
+    // desta função. Não chamar da própria thread servo. Com o servo parado,
+    // retorna na hora.
+    void aguardarQuiescencia() const {
+        const uint64_t g = geracao.load();
+        if ((g & 1) == 0) return; // Fora de qualquer gancho
+        while (geracao.load() == g) std::this_thread::yield();
+    }
+
+    // --- Chamadas pela thread servo ---
+
+    void notificar(const HapticSample& amostra) const {
+        Secao secao(geracao);
+        for (const auto& slot : observadores) {
+            Observador f = slot.funcao.load();
+            if (f) f(slot.contexto.load(std::memory_order_relaxed), amostra);
+        }
+    }
+
+    bool forcaExterna(uint64_t agoraNs, HapticVec3& forca) const {
+        Secao secao(geracao);
+        FonteForca f = fonte.funcao.load();
+        return f && f(fonte.contexto.load(std::memory_order_relaxed), agoraNs, forca);
+    }
+
+private:
+    // Geração ímpar enquanto a thread servo está dentro de notificar ou
+    // forcaExterna. Tudo seq_cst: a remoção de um gancho e a leitura da geração
+    // (aguardarQuiescencia) não podem ser reordenadas com a entrada na seção e
+    // a leitura do gancho (thread servo).
+    struct Secao {
+        explicit Secao(std::atomic<uint64_t>& g) : g(g) { g.fetch_add(1); }
+        ~Secao() { g.fetch_add(1); }
+        std::atomic<uint64_t>& g;
+    };
+
+    template <typename F>
+    struct Slot {
+        std::atomic<F> funcao{nullptr};
+        std::atomic<void*> contexto{nullptr};
+    };
+    Slot<Observador> observadores[MAX_OBSERVADORES];
+    Slot<FonteForca> fonte;
+    mutable std::atomic<uint64_t> geracao{0};
+};
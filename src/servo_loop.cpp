@@ -0,0 +1,100 @@
+#include "servo_loop.h"
+#include "alloc_tracker.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include "realtime.h"
+#include <cerrno>
+#include <pthread.h>
+#include <time.h>
+
+namespace {
+
+Registro::Modulo g_log{"servo"};
+
+timespec paraTimespec(uint64_t ns) {
+    timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ull);
+    ts.tv_nsec = (long)(ns % 1000000000ull);
+    return ts;
+}
+
+} // namespace
+
+uint64_t relogioMonotonicoNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool LacoServo::iniciar(const std::string& nomeThread, double taxaHz, Iteracao iteracao, const OpcoesServo& opcoes) {
+    if (ativo.load()) return false;
+    if (!(taxaHz > 0.0) || !iteracao) {
+        Registro::erro(g_log, "Laço servo '{}': configuração inválida ({} Hz)", nomeThread, taxaHz);
+        return false;
+    }
+    taxa = taxaHz;
+    nome = nomeThread;
+    funcao = std::move(iteracao);
+    config = opcoes;
+    contador.store(0);
+    alocacoesLaco.store(0);
+    politica.store(0);
+    stats.configurar(taxaHz);
+    ativo.store(true);
+    thread = std::thread(&LacoServo::executar, this);
+    return true;
+}
+
+void LacoServo::parar() {
+    ativo.store(false);
+    if (!thread.joinable()) return;
+    thread.join();
+    if (alocacoesLaco.load() > 0)
+        Registro::aviso(g_log, "Laço servo '{}' alocou memória no heap em {} iterações.", nome, alocacoesLaco.load());
+}
+
+void LacoServo::executar() {
+    pthread_setname_np(pthread_self(), nome.substr(0, 15).c_str());
+    ParadaEmergencia::prepararThread(); // Antes do laço: aloca a pilha alternativa do tratador fatal
+    const TempoReal::RelatorioThread rt = TempoReal::prepararThread(config.nucleo, config.prioridadeFifo, config.tempoReal, taxa);
+    if (config.tempoReal || !rt.detalhes.empty()) {
+        // Relatado antes do laço (o primeiro registro da thread aloca o anel)
+        Registro::info(g_log, "Laço servo '{}': {}, afinidade {}, pilha pré-faltada {}{}{}{}", nome,
+                       TempoReal::nomePolitica(rt.politica),
+                       rt.afinidade ? std::to_string(config.nucleo) : std::string("não"), rt.pilhaPreFaltada,
+                       rt.detalhes.empty() ? "" : " (", rt.detalhes, rt.detalhes.empty() ? "" : ")");
+    }
+    politica.store((int)rt.politica, std::memory_order_relaxed);
+
+    const double periodoNs = 1.0e9 / taxa;
+    uint64_t inicio = config.epocaNs ? config.epocaNs : relogioMonotonicoNs();
+    if (inicio > relogioMonotonicoNs()) {
+        // Época comum a vários laços: espera o tick 0 agendado para ficar em fase com os outros
+        timespec ts = paraTimespec(inicio);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+    }
+    uint64_t tick = 0;
+    uint64_t inicioAnterior = 0;
+    while (ativo.load(std::memory_order_relaxed)) {
+        const uint64_t inicioIteracao = relogioMonotonicoNs();
+        const uint64_t alocacoesAntes = ContadorAlocacoes::alocacoesThread();
+        funcao(tick, inicioIteracao);
+        if (ContadorAlocacoes::alocacoesThread() != alocacoesAntes)
+            alocacoesLaco.store(alocacoesLaco.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        tick++;
+        contador.store(tick, std::memory_order_relaxed);
+
+        uint64_t prazo = inicio + (uint64_t)(tick * periodoNs);
+        uint64_t agora = relogioMonotonicoNs();
+        // Prazo perdido: a iteração terminou depois do início previsto da próxima
+        stats.registrar(inicioAnterior ? inicioIteracao - inicioAnterior : 0, agora - inicioIteracao, agora > prazo);
+        inicioAnterior = inicioIteracao;
+        if (agora > prazo + (uint64_t)(100 * periodoNs)) {
+            // Muito atrasado (máquina suspensa, depurador): ressincroniza em vez de correr em rajada
+            inicio = agora - (uint64_t)(tick * periodoNs);
+            continue;
+        }
+        timespec ts = paraTimespec(prazo);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+    }
+}
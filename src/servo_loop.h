@@ -0,0 +1,61 @@
+// servo_loop.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "servo_stats.h"
+#include <string>
+#include <thread>
+
+// Relógio monotônico em nanossegundos (CLOCK_MONOTONIC), base de tempo de todo o subsistema háptico.
+uint64_t relogioMonotonicoNs();
+
+// Onde e como a thread servo roda. Tudo é "melhor esforço": sem permissão ou
+// com núcleo inexistente o laço roda assim mesmo, só sem a medida.
+struct OpcoesServo {
+    int nucleo = -1;          // CPU dedicada (-1: sem afinidade)
+    int prioridadeFifo = 0;   // SCHED_FIFO 1..99 quando permitido; 0 mantém a política normal
+    uint64_t epocaNs = 0;     // Instante agendado do tick 0; laços com a mesma época ficam em fase (0 = agora)
+    bool tempoReal = false;   // SCHED_DEADLINE/FIFO e pilha pré-faltada (ver realtime.h)
+};
+
+// Laço servo de taxa fixa numa thread própria, usado pelo dispositivo real
+// (haptics.cpp) e pelo simulado (haptic_simulator.cpp).
+// Os prazos são absolutos, calculados a partir do início, então o erro de
+// temporização não se acumula; se o laço ficar muito atrasado ele ressincroniza
+// em vez de executar uma rajada de iterações.
+// Cada iteração é cronometrada: período, tempo de execução e prazos perdidos
+// vão para histogramas lidos sem locks pela UI.
+class LacoServo {
+public:
+    // Recebe o número da iteração e o instante (ns) em que ela começou.
+    using Iteracao = std::function<void(uint64_t tick, uint64_t inicioNs)>;
+
+    ~LacoServo() { parar(); }
+
+    bool iniciar(const std::string& nome, double taxaHz, Iteracao iteracao, const OpcoesServo& opcoes = OpcoesServo());
+    void parar();
+
+    bool rodando() const { return ativo.load(std::memory_order_relaxed); }
+    uint64_t ticks() const { return contador.load(std::memory_order_relaxed); }
+    double taxaHz() const { return taxa; }
+    const EstatisticasServo& estatisticas() const { return stats; }
+    // Política efetivamente aplicada à thread (TempoReal::Politica).
+    int politicaAplicada() const { return politica.load(std::memory_order_relaxed); }
+    // Iterações que alocaram no heap (só medido com ENABLE_ALLOC_TRACKING).
+    uint64_t iteracoesComAlocacao() const { return alocacoesLaco.load(std::memory_order_relaxed); }
+
+private:
+    void executar();
+
+    std::thread thread;
+    std::atomic<bool> ativo{false};
+    std::atomic<uint64_t> contador{0};
+    std::atomic<uint64_t> alocacoesLaco{0};
+    std::atomic<int> politica{0};
+    double taxa = 1000.0;
+    std::string nome;
+    Iteracao funcao;
+    OpcoesServo config;
+    EstatisticasServo stats;
+};
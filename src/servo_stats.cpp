@@ -0,0 +1,140 @@
+#include "servo_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+int HistogramaHdr::indice(uint64_t valorNs) {
+    if (valorNs < (uint64_t)LINEAR) return (int)valorNs;
+    int msb = 63 - __builtin_clzll(valorNs);
+    if (msb > MAX_BIT) return BALDES - 1;
+    int deslocamento = msb - BITS_SUB;
+    int sub = (int)(valorNs >> deslocamento) - SUB_BALDES; // 0..31
+    return LINEAR + (msb - 6) * SUB_BALDES + sub;
+}
+
+uint64_t HistogramaHdr::limiteInferior(int i) {
+    if (i < LINEAR) return (uint64_t)i;
+    int msb = (i - LINEAR) / SUB_BALDES + 6;
+    int sub = (i - LINEAR) % SUB_BALDES;
+    return (uint64_t)(SUB_BALDES + sub) << (msb - BITS_SUB);
+}
+
+void HistogramaHdr::registrar(uint64_t valorNs) {
+    // Escritor único: load + store relaxados bastam e evitam instruções com lock
+    auto incrementar = [](std::atomic<uint64_t>& a, uint64_t v) {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    };
+    incrementar(contagens[indice(valorNs)], 1);
+    incrementar(contagemTotal, 1);
+    incrementar(soma, valorNs);
+    if (valorNs > valorMaximo.load(std::memory_order_relaxed)) valorMaximo.store(valorNs, std::memory_order_relaxed);
+    if (valorNs < valorMinimo.load(std::memory_order_relaxed)) valorMinimo.store(valorNs, std::memory_order_relaxed);
+}
+
+void HistogramaHdr::zerar() {
+    for (auto& c : contagens) c.store(0, std::memory_order_relaxed);
+    contagemTotal.store(0, std::memory_order_relaxed);
+    soma.store(0, std::memory_order_relaxed);
+    valorMaximo.store(0, std::memory_order_relaxed);
+    valorMinimo.store(UINT64_MAX, std::memory_order_relaxed);
+}
+
+uint64_t HistogramaHdr::minimo() const {
+    uint64_t v = valorMinimo.load(std::memory_order_relaxed);
+    return v == UINT64_MAX ? 0 : v;
+}
+
+double HistogramaHdr::media() const {
+    uint64_t n = total();
+    return n ? (double)soma.load(std::memory_order_relaxed) / (double)n : 0.0;
+}
+
+uint64_t HistogramaHdr::percentil(double p) const {
+    uint64_t n = total();
+    if (n == 0) return 0;
+    uint64_t alvo = (uint64_t)((p / 100.0) * (double)n);
+    if (alvo >= n) alvo = n - 1;
+    uint64_t acumulado = 0;
+    for (int i = 0; i < BALDES; ++i) {
+        acumulado += contagens[i].load(std::memory_order_relaxed);
+        if (acumulado > alvo) return limiteInferior(i);
+    }
+    return maximo();
+}
+
+void HistogramaHdr::escreverBaldes(std::ostream& saida) const {
+    for (int i = 0; i < BALDES; ++i) {
+        uint64_t c = contagens[i].load(std::memory_order_relaxed);
+        if (c) saida << limiteInferior(i) << " " << c << "\n";
+    }
+}
+
+void EstatisticasServo::configurar(double taxaHz) {
+    taxaNominal.store(taxaHz, std::memory_order_relaxed);
+    zerar();
+}
+
+void EstatisticasServo::registrar(uint64_t periodoNs, uint64_t execucaoNs, bool prazoPerdido) {
+    if (periodoNs) histPeriodo.registrar(periodoNs); // A primeira iteração não tem período
+    execucao.registrar(execucaoNs);
+    if (prazoPerdido) perdidos.store(perdidos.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void EstatisticasServo::zerar() {
+    histPeriodo.zerar();
+    execucao.zerar();
+    perdidos.store(0, std::memory_order_relaxed);
+}
+
+double EstatisticasServo::taxaMedidaHz() const {
+    double media = histPeriodo.media();
+    return media > 0.0 ? 1.0e9 / media : 0.0;
+}
+
+double EstatisticasServo::jitterNs() const {
+    const double nominal = taxaNominalHz();
+    if (!(nominal > 0.0) || histPeriodo.total() == 0) return 0.0;
+    const double nominalNs = 1.0e9 / nominal;
+    return std::max(std::fabs(histPeriodo.percentil(99) - nominalNs), std::fabs(nominalNs - histPeriodo.percentil(1)));
+}
+
+void EstatisticasServo::escreverRelatorio(std::ostream& saida, const char* nome) const {
+    auto us = [](uint64_t ns) { return (double)ns / 1000.0; };
+    time_t agora = time(nullptr);
+    char quando[64];
+    struct tm tmLocal;
+    localtime_r(&agora, &tmLocal);
+    strftime(quando, sizeof(quando), "%Y-%m-%d %H:%M:%S", &tmLocal);
+
+    saida << std::fixed << std::setprecision(2);
+    saida << "# Laço servo: " << nome << " (" << quando << ")\n";
+    saida << "taxa_nominal_hz " << taxaNominalHz() << "\n";
+    saida << "taxa_medida_hz " << taxaMedidaHz() << "\n";
+    saida << "iteracoes " << iteracoes() << "\n";
+    saida << "prazos_perdidos " << prazosPerdidos() << "\n";
+    saida << "jitter_us " << jitterNs() / 1000.0 << "\n";
+    for (int h = 0; h < 2; ++h) {
+        const HistogramaHdr& hist = h == 0 ? histPeriodo : execucao;
+        const char* rotulo = h == 0 ? "periodo" : "execucao";
+        saida << rotulo << "_us min " << us(hist.minimo()) << " p50 " << us(hist.percentil(50)) << " p99 " << us(hist.percentil(99))
+              << " p99.9 " << us(hist.percentil(99.9)) << " max " << us(hist.maximo()) << " media " << hist.media() / 1000.0 << "\n";
+    }
+    saida << "# histograma periodo (limite_inferior_ns contagem)\n";
+    histPeriodo.escreverBaldes(saida);
+    saida << "# histograma execucao (limite_inferior_ns contagem)\n";
+    execucao.escreverBaldes(saida);
+}
+
+bool EstatisticasServo::salvar(const char* caminho, const char* nome) const {
+    std::ofstream arquivo(caminho);
+    if (!arquivo.is_open()) {
+        std::cerr << "Erro ao salvar estatísticas do servo em: " << caminho << std::endl;
+        return false;
+    }
+    escreverRelatorio(arquivo, nome);
+    std::cout << "Estatísticas do servo salvas em: " << caminho << std::endl;
+    return true;
+}
@@ -0,0 +1,71 @@
+// servo_stats.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+// Histograma log-linear no estilo HDR para durações em nanossegundos:
+// valores abaixo de 64 ns têm balde próprio; acima disso cada potência de dois
+// é dividida em 32 baldes (erro relativo < 3,2%), até ~18 minutos.
+// Um único escritor (a thread servo) e qualquer número de leitores: as
+// contagens são atômicas relaxadas, sem locks.
+class HistogramaHdr {
+public:
+    static constexpr int BITS_SUB = 5;
+    static constexpr int SUB_BALDES = 1 << BITS_SUB;        // 32
+    static constexpr int LINEAR = SUB_BALDES * 2;           // 64 valores exatos
+    static constexpr int MAX_BIT = 40;                      // 2^40 ns ≈ 18 min
+    static constexpr int BALDES = LINEAR + (MAX_BIT - 6 + 1) * SUB_BALDES;
+
+    void registrar(uint64_t valorNs);
+    void zerar();
+
+    uint64_t total() const { return contagemTotal.load(std::memory_order_relaxed); }
+    uint64_t maximo() const { return valorMaximo.load(std::memory_order_relaxed); }
+    uint64_t minimo() const;
+    double media() const;
+    uint64_t percentil(double p) const; // p em 0..100; limite inferior do balde
+
+    // Escreve "limite_inferior_ns contagem" para cada balde não vazio.
+    void escreverBaldes(std::ostream& saida) const;
+
+    static int indice(uint64_t valorNs);
+    static uint64_t limiteInferior(int indice);
+
+private:
+    std::atomic<uint64_t> contagens[BALDES] = {};
+    std::atomic<uint64_t> contagemTotal{0};
+    std::atomic<uint64_t> soma{0};
+    std::atomic<uint64_t> valorMaximo{0};
+    std::atomic<uint64_t> valorMinimo{UINT64_MAX};
+};
+
+// Estatísticas de um laço servo: período entre inícios de iteração, tempo de
+// execução de cada iteração e prazos perdidos (iteração terminou depois do
+// início previsto da seguinte).
+class EstatisticasServo {
+public:
+    void configurar(double taxaHz);
+    void registrar(uint64_t periodoNs, uint64_t execucaoNs, bool prazoPerdido);
+    void zerar();
+
+    double taxaNominalHz() const { return taxaNominal.load(std::memory_order_relaxed); }
+    double taxaMedidaHz() const;      // 1 / período médio
+    uint64_t prazosPerdidos() const { return perdidos.load(std::memory_order_relaxed); }
+    uint64_t iteracoes() const { return execucao.total(); }
+    // Maior desvio do período nominal entre os percentis 1 e 99 (0 sem amostras)
+    double jitterNs() const;
+
+    const HistogramaHdr& periodo() const { return histPeriodo; }
+    const HistogramaHdr& tempoExecucao() const { return execucao; }
+
+    // Relatório legível + baldes dos histogramas, para o arquivo de dump.
+    void escreverRelatorio(std::ostream& saida, const char* nome) const;
+    bool salvar(const char* caminho, const char* nome) const;
+
+private:
+    std::atomic<double> taxaNominal{0.0}; // Escrita pela UI, lida pela thread servo
+    HistogramaHdr histPeriodo;
+    HistogramaHdr execucao;
+    std::atomic<uint64_t> perdidos{0};
+};
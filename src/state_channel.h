@@ -0,0 +1,63 @@
+// state_channel.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Canal de estado sem locks (seqlock) entre um único produtor e vários leitores.
+//
+// O produtor (ex.: a thread servo a 1 kHz) publica sem nunca esperar: a escrita
+// é um contador de sequência ímpar, a cópia dos dados e o contador par.
+// Leitores (UI, loggers) copiam os dados e conferem que a sequência não mudou;
+// se mudou, tentam de novo um número limitado de vezes. Nenhum lado bloqueia
+// ou faz chamada de sistema, então ler o estado não adiciona jitter ao laço servo.
+//
+// Os dados ficam em palavras atômicas de 64 bits para que a leitura concorrente
+// com a escrita seja bem definida no modelo de memória do C++.
+template <typename T>
+class CanalEstado {
+    static_assert(std::is_trivially_copyable<T>::value, "CanalEstado exige tipo trivialmente copiável");
+    static constexpr size_t PALAVRAS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+    static constexpr int TENTATIVAS_LEITURA = 64;
+
+    // Apenas uma thread pode publicar em cada canal.
+    void publicar(const T& valor) {
+        uint64_t buffer[PALAVRAS] = {};
+        std::memcpy(buffer, &valor, sizeof(T));
+
+        const uint64_t seq = sequencia.load(std::memory_order_relaxed);
+        sequencia.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < PALAVRAS; ++i) dados[i].store(buffer[i], std::memory_order_relaxed);
+        sequencia.store(seq + 2, std::memory_order_release);
+    }
+
+    // Copia a última amostra coerente. Retorna false se nada foi publicado ainda
+    // ou se o produtor escreveu durante todas as tentativas (raríssimo).
+    bool ler(T& saida) const {
+        uint64_t buffer[PALAVRAS];
+        for (int tentativa = 0; tentativa < TENTATIVAS_LEITURA; ++tentativa) {
+            const uint64_t antes = sequencia.load(std::memory_order_acquire);
+            if (antes & 1u) continue; // Escrita em andamento
+            for (size_t i = 0; i < PALAVRAS; ++i) buffer[i] = dados[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t depois = sequencia.load(std::memory_order_relaxed);
+            if (antes == depois) {
+                if (antes == 0) return false;
+                std::memcpy(&saida, buffer, sizeof(T));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Número de publicações feitas até agora.
+    uint64_t publicacoes() const { return sequencia.load(std::memory_order_acquire) / 2; }
+
+private:
+    alignas(64) std::atomic<uint64_t> sequencia{0};
+    std::atomic<uint64_t> dados[PALAVRAS] = {};
+};
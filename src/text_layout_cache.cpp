@@ -0,0 +1,81 @@
+#include "text_layout_cache.h"
+
+namespace {
+
+bool ehEspaco(char c) { return c == ' ' || c == '\t'; }
+
+void calcularLayout(ImFont* fonte, float tamanhoFonte, const std::string& texto, float larguraQuebra, LayoutTexto& saida) {
+    saida.linhas.clear();
+    saida.tamanho = ImVec2(0.0f, 0.0f);
+    saida.alturaLinha = tamanhoFonte;
+    saida.conteudo = texto;
+
+    const char* base = texto.c_str();
+    const char* fimTexto = base + texto.size();
+    const float escala = tamanhoFonte / fonte->FontSize;
+    if (larguraQuebra < 1.0f) larguraQuebra = 1.0f;
+
+    // Mesma regra do ImGui::TextWrapped: quebra explícita em '\n' e quebra por
+    // palavra dentro de cada parágrafo, descartando espaços no início da linha.
+    const char* s = base;
+    while (s < fimTexto) {
+        const char* fimParagrafo = s;
+        while (fimParagrafo < fimTexto && *fimParagrafo != '\n') fimParagrafo++;
+
+        do {
+            const char* fimLinha = fonte->CalcWordWrapPositionA(escala, s, fimParagrafo, larguraQuebra);
+            if (fimLinha == s && s < fimParagrafo) fimLinha++; // Palavra maior que a largura: garante progresso
+
+            float largura = fonte->CalcTextSizeA(tamanhoFonte, FLT_MAX, 0.0f, s, fimLinha).x;
+            if (largura > saida.tamanho.x) saida.tamanho.x = largura;
+            saida.linhas.push_back({ (uint32_t)(s - base), (uint32_t)(fimLinha - base) });
+
+            s = fimLinha;
+            while (s < fimParagrafo && ehEspaco(*s)) s++;
+        } while (s < fimParagrafo);
+
+        if (fimParagrafo < fimTexto && s == fimParagrafo) s++; // Consome o '\n'
+    }
+    if (saida.linhas.empty()) saida.linhas.push_back({ 0, 0 });
+    saida.tamanho.y = saida.alturaLinha * (float)saida.linhas.size();
+}
+
+} // namespace
+
+void CacheLayoutTexto::iniciarQuadro(ImFont* fonte, const ImVec2& tamanhoJanela) {
+    if (fonte != fonteAtual || tamanhoJanela.x != tamanhoJanelaAtual.x || tamanhoJanela.y != tamanhoJanelaAtual.y) {
+        invalidar();
+        fonteAtual = fonte;
+        tamanhoJanelaAtual = tamanhoJanela;
+    }
+}
+
+void CacheLayoutTexto::invalidar() {
+    cache.clear();
+}
+
+const LayoutTexto& CacheLayoutTexto::obter(ImGuiID idTexto, const std::string& texto, float larguraQuebra) {
+    ImFont* fonte = ImGui::GetFont();
+    LayoutTexto& layout = cache[Chave{ idTexto, larguraQuebra, fonte }];
+    if (layout.linhas.empty() || layout.conteudo != texto) {
+        calcularLayout(fonte, ImGui::GetFontSize(), texto, larguraQuebra, layout);
+    }
+    return layout;
+}
+
+void TextoQuebradoCache(CacheLayoutTexto& cache, const char* idTexto, const std::string& texto) {
+    float largura = ImGui::GetContentRegionAvail().x;
+    const LayoutTexto& layout = cache.obter(ImGui::GetID(idTexto), texto, largura);
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImFont* fonte = ImGui::GetFont();
+    ImU32 cor = ImGui::GetColorU32(ImGuiCol_Text);
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    const char* base = texto.c_str();
+    for (const auto& linha : layout.linhas) {
+        if (linha.fim > linha.inicio)
+            drawList->AddText(fonte, layout.alturaLinha, pos, cor, base + linha.inicio, base + linha.fim);
+        pos.y += layout.alturaLinha;
+    }
+    ImGui::Dummy(layout.tamanho);
+}
@@ -0,0 +1,56 @@
+// text_layout_cache.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "imgui.h"
+
+// Resultado da quebra de linhas de um texto: intervalos [inicio, fim) em bytes
+// dentro do texto original e o tamanho total ocupado.
+struct LayoutTexto {
+    struct Linha { uint32_t inicio; uint32_t fim; };
+    std::vector<Linha> linhas;
+    ImVec2 tamanho;
+    float alturaLinha = 0.0f;
+    // Cópia do texto usado no cálculo: o ponteiro de c_str() não identifica o
+    // conteúdo (o mesmo buffer pode receber outro texto, e vice-versa)
+    std::string conteudo;
+};
+
+// Cache das quebras de linha dos textos dos cards, para não re-medir o mesmo
+// texto com a mesma largura a cada quadro. A chave é (id do texto, largura, fonte);
+// o cache inteiro é descartado quando a janela muda de tamanho ou a fonte muda.
+class CacheLayoutTexto {
+public:
+    // Chamar uma vez por quadro, antes dos cards.
+    void iniciarQuadro(ImFont* fonte, const ImVec2& tamanhoJanela);
+    void invalidar();
+
+    const LayoutTexto& obter(ImGuiID idTexto, const std::string& texto, float larguraQuebra);
+    size_t entradas() const { return cache.size(); }
+
+private:
+    struct Chave {
+        ImGuiID id;
+        float largura;
+        const ImFont* fonte;
+        bool operator==(const Chave& o) const { return id == o.id && largura == o.largura && fonte == o.fonte; }
+    };
+    struct HashChave {
+        size_t operator()(const Chave& c) const {
+            size_t h = std::hash<ImGuiID>()(c.id);
+            h ^= std::hash<float>()(c.largura) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<const void*>()(c.fonte) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    std::unordered_map<Chave, LayoutTexto, HashChave> cache;
+    ImFont* fonteAtual = nullptr;
+    ImVec2 tamanhoJanelaAtual;
+};
+
+// Equivalente a ImGui::TextWrapped("%s", texto), mas usando as quebras em cache:
+// desenha as linhas direto na draw list e reserva o espaço com um único item.
+void TextoQuebradoCache(CacheLayoutTexto& cache, const char* idTexto, const std::string& texto);
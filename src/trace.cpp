@@ -0,0 +1,264 @@
+#include "trace.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<bool> Rastreamento::detalhe::ativo{false};
+
+namespace {
+
+Registro::Modulo g_log{"rastreamento"};
+
+constexpr size_t EVENTOS_POR_BLOCO = 4096;
+constexpr size_t MAX_BLOCOS = 256; // Até ~1M eventos por thread; o excedente é descartado
+constexpr size_t TAMANHO_DETALHE = 48;
+
+struct Evento {
+    const char* nome;
+    const char* categoria;
+    uint64_t inicioNs;
+    uint64_t duracaoNs;
+    char fase;                     // 'X' (span) ou 'i' (instante)
+    char detalhe[TAMANHO_DETALHE];
+};
+
+// Buffer de uma thread: só ela escreve. Os blocos são publicados antes do
+// contador, então o exportador pode ler qualquer evento abaixo de 'quantidade'.
+struct BufferThread {
+    long tid = 0;
+    char nomeThread[16] = {};
+    std::atomic<Evento*> blocos[MAX_BLOCOS] = {};
+    std::atomic<size_t> quantidade{0};
+    std::atomic<uint64_t> descartados{0};
+
+    ~BufferThread() {
+        for (auto& b : blocos) delete[] b.load();
+    }
+
+    Evento* reservar() {
+        size_t n = quantidade.load(std::memory_order_relaxed);
+        size_t bloco = n / EVENTOS_POR_BLOCO;
+        if (bloco >= MAX_BLOCOS) { descartados.fetch_add(1, std::memory_order_relaxed); return nullptr; }
+        Evento* b = blocos[bloco].load(std::memory_order_relaxed);
+        if (!b) {
+            b = new Evento[EVENTOS_POR_BLOCO];
+            blocos[bloco].store(b, std::memory_order_release);
+        }
+        return &b[n % EVENTOS_POR_BLOCO];
+    }
+
+    void publicar() { quantidade.fetch_add(1, std::memory_order_release); }
+
+    const Evento& evento(size_t i) const {
+        return blocos[i / EVENTOS_POR_BLOCO].load(std::memory_order_acquire)[i % EVENTOS_POR_BLOCO];
+    }
+
+    // Para reutilização por outra thread: mantém só o primeiro bloco
+    void esvaziar() {
+        for (size_t i = 1; i < MAX_BLOCOS; ++i) delete[] blocos[i].exchange(nullptr);
+        quantidade.store(0, std::memory_order_relaxed);
+        descartados.store(0, std::memory_order_relaxed);
+        tid = 0;
+        nomeThread[0] = '\0';
+    }
+};
+
+// Eventos de uma thread que já terminou, copiados no tamanho exato
+struct EventosEncerrados {
+    long tid = 0;
+    char nomeThread[16] = {};
+    std::vector<Evento> eventos;
+    uint64_t descartados = 0;
+
+    const Evento& evento(size_t i) const { return eventos[i]; }
+};
+
+// Buffers das threads vivas; ao terminar, a thread copia seus eventos para
+// 'encerradas' e devolve o buffer (com um bloco já alocado) a 'livres', de onde
+// a próxima thread o pega. Nada é liberado: threads destacadas podem ainda
+// gravar durante a destruição dos globais.
+struct RegistroBuffers {
+    std::vector<std::unique_ptr<BufferThread>> ativos;
+    std::vector<std::unique_ptr<BufferThread>> livres;
+    std::vector<EventosEncerrados> encerradas;
+};
+
+std::mutex g_mutexRegistro;
+RegistroBuffers& registro() {
+    static auto* r = new RegistroBuffers();
+    return *r;
+}
+
+thread_local BufferThread* t_buffer = nullptr;
+thread_local bool t_encerrada = false; // Depois da devolução: eventos tardios são descartados
+std::atomic<uint64_t> g_descartadosTardios{0};
+
+void devolverBuffer() {
+    BufferThread* buffer = t_buffer;
+    t_buffer = nullptr;
+    t_encerrada = true;
+    if (!buffer) return;
+    std::lock_guard<std::mutex> trava(g_mutexRegistro);
+    RegistroBuffers& r = registro();
+    const size_t n = buffer->quantidade.load(std::memory_order_relaxed);
+    if (n > 0 || buffer->descartados.load(std::memory_order_relaxed) > 0) {
+        EventosEncerrados copia;
+        copia.tid = buffer->tid;
+        std::memcpy(copia.nomeThread, buffer->nomeThread, sizeof(copia.nomeThread));
+        copia.eventos.reserve(n);
+        for (size_t i = 0; i < n; ++i) copia.eventos.push_back(buffer->evento(i));
+        copia.descartados = buffer->descartados.load(std::memory_order_relaxed);
+        r.encerradas.push_back(std::move(copia));
+    }
+    for (auto it = r.ativos.begin(); it != r.ativos.end(); ++it) {
+        if (it->get() != buffer) continue;
+        buffer->esvaziar();
+        r.livres.push_back(std::move(*it));
+        r.ativos.erase(it);
+        break;
+    }
+}
+
+// O destrutor roda quando a thread termina
+struct DevolucaoBuffer {
+    ~DevolucaoBuffer() { devolverBuffer(); }
+};
+
+BufferThread* bufferDaThread() {
+    if (t_buffer) return t_buffer;
+    if (t_encerrada) return nullptr;
+    thread_local DevolucaoBuffer devolucao;
+    (void)devolucao;
+    std::lock_guard<std::mutex> trava(g_mutexRegistro);
+    RegistroBuffers& r = registro();
+    if (r.livres.empty()) r.livres.push_back(std::make_unique<BufferThread>());
+    BufferThread* buffer = r.livres.back().get();
+    buffer->tid = (long)syscall(SYS_gettid);
+    pthread_getname_np(pthread_self(), buffer->nomeThread, sizeof(buffer->nomeThread));
+    r.ativos.push_back(std::move(r.livres.back()));
+    r.livres.pop_back();
+    t_buffer = buffer;
+    return buffer;
+}
+
+void registrar(char fase, const char* nome, const char* categoria, uint64_t inicioNs, uint64_t duracaoNs, const char* detalhe) {
+    BufferThread* buffer = bufferDaThread();
+    if (!buffer) { g_descartadosTardios.fetch_add(1, std::memory_order_relaxed); return; }
+    Evento* e = buffer->reservar();
+    if (!e) return;
+    e->nome = nome;
+    e->categoria = categoria;
+    e->inicioNs = inicioNs;
+    e->duracaoNs = duracaoNs;
+    e->fase = fase;
+    // Textos longos (caminhos) mantêm o final, começando num caractere UTF-8 inteiro
+    const char* origem = detalhe ? detalhe : "";
+    size_t n = std::strlen(origem);
+    if (n > TAMANHO_DETALHE - 1) {
+        origem += n - (TAMANHO_DETALHE - 1);
+        while (((unsigned char)*origem & 0xC0) == 0x80) origem++;
+        n = std::strlen(origem);
+    }
+    std::memcpy(e->detalhe, origem, n);
+    e->detalhe[n] = '\0';
+    buffer->publicar();
+}
+
+void escreverTextoJson(std::ostream& out, const char* texto) {
+    out << '"';
+    for (const char* c = texto; *c; ++c) {
+        unsigned char u = (unsigned char)*c;
+        if (u == '"' || u == '\\') out << '\\' << *c;
+        else if (u < 0x20) { char buf[8]; std::snprintf(buf, sizeof(buf), "\\u%04x", u); out << buf; }
+        else out << *c;
+    }
+    out << '"';
+}
+
+// Microssegundos com resolução de nanossegundo, como o formato espera
+void escreverMicros(std::ostream& out, uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03llu", (unsigned long long)(ns / 1000), (unsigned long long)(ns % 1000));
+    out << buf;
+}
+
+} // namespace
+
+void Rastreamento::ativar(bool valor) {
+    detalhe::ativo.store(valor, std::memory_order_relaxed);
+}
+
+void Rastreamento::span(const char* nome, const char* categoria, uint64_t inicioNs, uint64_t fimNs, const char* detalhe) {
+    registrar('X', nome, categoria, inicioNs, fimNs > inicioNs ? fimNs - inicioNs : 0, detalhe);
+}
+
+void Rastreamento::instante(const char* nome, const char* categoria, const char* detalhe) {
+    if (!ativo()) return;
+    registrar('i', nome, categoria, agoraNs(), 0, detalhe);
+}
+
+bool Rastreamento::exportar(const std::string& caminho) {
+    std::ofstream out(caminho, std::ios::trunc);
+    if (!out) { Registro::erro(g_log, "Não foi possível gravar o rastreamento em {}", caminho); return false; }
+    const long pid = (long)getpid();
+    size_t total = 0;
+    bool primeiro = true;
+    auto separar = [&] { if (!primeiro) out << ",\n"; primeiro = false; };
+
+    // Threads vivas (BufferThread) e encerradas (EventosEncerrados) têm a mesma forma
+    auto escreverThread = [&](const auto& thread, size_t n) {
+        separar();
+        out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << thread.tid << ",\"args\":{\"name\":";
+        escreverTextoJson(out, thread.nomeThread[0] ? thread.nomeThread : "?");
+        out << "}}";
+        for (size_t i = 0; i < n; ++i) {
+            const Evento& e = thread.evento(i);
+            separar();
+            out << "{\"ph\":\"" << e.fase << "\",\"name\":";
+            escreverTextoJson(out, e.nome);
+            out << ",\"cat\":";
+            escreverTextoJson(out, e.categoria);
+            out << ",\"pid\":" << pid << ",\"tid\":" << thread.tid << ",\"ts\":";
+            escreverMicros(out, e.inicioNs);
+            if (e.fase == 'X') { out << ",\"dur\":"; escreverMicros(out, e.duracaoNs); }
+            else out << ",\"s\":\"t\"";
+            if (e.detalhe[0]) { out << ",\"args\":{\"detalhe\":"; escreverTextoJson(out, e.detalhe); out << "}"; }
+            out << "}";
+        }
+        total += n;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::unique_lock<std::mutex> trava(g_mutexRegistro);
+    for (const auto& thread : registro().encerradas) escreverThread(thread, thread.eventos.size());
+    for (const auto& buffer : registro().ativos) escreverThread(*buffer, buffer->quantidade.load(std::memory_order_acquire));
+    trava.unlock();
+    out << "\n]}\n";
+    if (!out) { Registro::erro(g_log, "Falha ao gravar o rastreamento em {}", caminho); return false; }
+    const uint64_t descartados = eventosDescartados();
+    if (descartados) Registro::aviso(g_log, "Rastreamento salvo em {} ({} eventos, {} descartados)", caminho, total, descartados);
+    else Registro::info(g_log, "Rastreamento salvo em {} ({} eventos)", caminho, total);
+    return true;
+}
+
+uint64_t Rastreamento::eventosDescartados() {
+    std::lock_guard<std::mutex> trava(g_mutexRegistro);
+    uint64_t total = g_descartadosTardios.load(std::memory_order_relaxed);
+    for (const auto& thread : registro().encerradas) total += thread.descartados;
+    for (const auto& buffer : registro().ativos) total += buffer->descartados.load(std::memory_order_relaxed);
+    return total;
+}
+
+void lerOpcoesRastreamento(int argc, char** argv, std::string& caminho) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) caminho = argv[++i];
+    }
+    if (!caminho.empty()) Rastreamento::ativar();
+}
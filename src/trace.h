@@ -0,0 +1,56 @@
+// trace.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Rastreamento de inicialização e execução, exportado no formato de eventos
+// do Chrome (chrome://tracing, ui.perfetto.dev).
+//
+// Cada thread grava num buffer próprio, sem locks; o exportador lê o que já foi
+// publicado. Desativado, um escopo custa um load relaxado de um atômico, então
+// a instrumentação fica compilada também nas versões de produção.
+namespace Rastreamento {
+    namespace detalhe {
+        extern std::atomic<bool> ativo;
+    }
+
+    inline bool ativo() { return detalhe::ativo.load(std::memory_order_relaxed); }
+    void ativar(bool valor = true);
+
+    // Relógio dos eventos; o mesmo steady_clock do perfilador de quadros.
+    inline uint64_t agoraNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 'nome' e 'categoria' precisam ter vida estática (literais); 'detalhe' é
+    // copiado (truncado) para o evento, ex.: o caminho de um jogo.
+    void span(const char* nome, const char* categoria, uint64_t inicioNs, uint64_t fimNs, const char* detalhe = nullptr);
+    void instante(const char* nome, const char* categoria, const char* detalhe = nullptr);
+
+    // Grava todos os eventos publicados até agora. Pode ser chamada a qualquer
+    // momento (menu) e de novo no fim; cada chamada reescreve o arquivo.
+    bool exportar(const std::string& caminho);
+    uint64_t eventosDescartados();
+}
+
+// Span do escopo atual. Com o rastreamento desativado não lê o relógio.
+class EscopoRastreio {
+public:
+    explicit EscopoRastreio(const char* nome, const char* categoria = "app", const char* detalhe = nullptr)
+        : nome(Rastreamento::ativo() ? nome : nullptr), categoria(categoria), detalhe(detalhe),
+          inicioNs(this->nome ? Rastreamento::agoraNs() : 0) {}
+    ~EscopoRastreio() { if (nome) Rastreamento::span(nome, categoria, inicioNs, Rastreamento::agoraNs(), detalhe); }
+    EscopoRastreio(const EscopoRastreio&) = delete;
+    EscopoRastreio& operator=(const EscopoRastreio&) = delete;
+private:
+    const char* nome;
+    const char* categoria;
+    const char* detalhe;
+    uint64_t inicioNs;
+};
+
+// Lê --trace arquivo.json (ativa o rastreamento e exporta ao sair).
+void lerOpcoesRastreamento(int argc, char** argv, std::string& caminho);
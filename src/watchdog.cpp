@@ -0,0 +1,326 @@
+#include "watchdog.h"
+#include "emergency_stop.h"
+#include "logger.h"
+#include "metrics.h"
+#include "process_launcher.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace {
+
+Registro::Modulo g_log{"vigia"};
+
+constexpr int MAX_QUADROS_PILHA = 64;
+constexpr int PRAZO_CAPTURA_MS = 200;          // Espera pelo tratador na thread principal
+constexpr int PRAZO_FORCA_ZERO_MS = 200;       // Para o servo aplicar força zero antes do exec
+constexpr int MAX_REINICIOS = 3;               // Por execução do inicializador: evita laço de reinícios
+constexpr const char* VARIAVEL_REINICIOS = "JARDIM_VIGIA_REINICIOS";
+constexpr unsigned FECHAR_NO_EXEC = 1u << 2;   // CLOSE_RANGE_CLOEXEC (Linux 5.11)
+
+struct Estado {
+    Vigia::Configuracao config;
+    pthread_t principal{};
+    pid_t tidPrincipal = 0;
+    int sinal = 0;
+    std::thread thread;
+    std::mutex mutex;                // Só para acordar a thread no encerramento
+    std::condition_variable cv;
+    bool parar = false;
+};
+
+Estado& estado() {
+    static Estado e;
+    return e;
+}
+
+// Escritos só pela thread principal, lidos pela vigia
+std::atomic<uint64_t> g_batimentoNs{0};    // 0 = ociosa ou ainda não vigiada
+std::atomic<const char*> g_etapa{"inicialização"};
+std::atomic<uint64_t> g_batimentos{0};
+std::atomic<uint64_t> g_travamentos{0};
+
+void coletarTravamentos(Metricas::Pagina& pagina) {
+    pagina.cabecalho("jardim_ui_stalls_total", "Quadros ou etapas que passaram do orçamento da vigia.", "counter");
+    pagina.valor("jardim_ui_stalls_total", (double)g_travamentos.load(std::memory_order_relaxed));
+}
+
+Metricas::Coletor g_coletorTravamentos{coletarTravamentos};
+
+// Pilha gravada pelo tratador de sinal na thread principal
+void* g_pilha[MAX_QUADROS_PILHA];
+std::atomic<int> g_profundidade{0};
+std::atomic<bool> g_capturada{false};
+uintptr_t g_pilhaInicio = 0;   // Extensão da pilha da thread principal, lida em iniciar()
+uintptr_t g_pilhaFim = 0;
+
+// Percorre a cadeia de ponteiros de quadro (-fno-omit-frame-pointer) a partir
+// do contexto interrompido, lendo só dentro da pilha da thread principal.
+// Nada de backtrace(): o unwinder da libgcc procura as tabelas de unwind com
+// dl_iterate_phdr, que toma a trava do carregador, e a UI pode ter travado
+// justamente dentro de um dlopen (driver GL). Quadros de bibliotecas sem
+// ponteiro de quadro encerram a cadeia; o primeiro (onde parou) sempre sai.
+void tratadorCaptura(int, siginfo_t*, void* contexto) {
+    const int errnoSalvo = errno;
+    const ucontext_t* uc = static_cast<const ucontext_t*>(contexto);
+    int profundidade = 0;
+#if defined(__x86_64__)
+    uintptr_t pc = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+    uintptr_t quadro = (uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+#elif defined(__aarch64__)
+    uintptr_t pc = (uintptr_t)uc->uc_mcontext.pc;
+    uintptr_t quadro = (uintptr_t)uc->uc_mcontext.regs[29];
+#else
+    (void)uc;
+    uintptr_t pc = 0, quadro = 0;
+#endif
+    if (pc) g_pilha[profundidade++] = (void*)pc;
+    // Cada quadro: [ponteiro do quadro de quem chamou, endereço de retorno]
+    while (profundidade < MAX_QUADROS_PILHA && quadro % sizeof(uintptr_t) == 0 &&
+           quadro >= g_pilhaInicio && quadro + 2 * sizeof(uintptr_t) <= g_pilhaFim) {
+        const uintptr_t* q = reinterpret_cast<const uintptr_t*>(quadro);
+        if (q[1] == 0) break;
+        g_pilha[profundidade++] = (void*)q[1];
+        if (q[0] <= quadro) break; // A pilha cresce para baixo: quem chamou fica acima
+        quadro = q[0];
+    }
+    g_profundidade.store(profundidade, std::memory_order_relaxed);
+    g_capturada.store(true, std::memory_order_release);
+    errno = errnoSalvo;
+}
+
+std::string lerTarefa(const char* arquivo) {
+    std::ifstream in("/proc/self/task/" + std::to_string(estado().tidPrincipal) + "/" + arquivo);
+    std::string linha;
+    std::getline(in, linha);
+    return linha;
+}
+
+// Estado do escalonador (R, S, D...) da thread principal, de /proc/.../stat
+std::string estadoKernel() {
+    const std::string stat = lerTarefa("stat");
+    // "tid (nome) S ...": o nome pode conter espaços e parênteses
+    const size_t fecha = stat.rfind(')');
+    return fecha != std::string::npos && fecha + 2 < stat.size() ? stat.substr(fecha + 2, 1) : "?";
+}
+
+// "binario(_ZN3Foo3barEv+0x1c) [0x4005d0]" -> "binario(Foo::bar()+0x1c) [0x4005d0]"
+std::string simbolizar(const char* linha) {
+    std::string texto = linha;
+    const size_t abre = texto.find('(');
+    const size_t mais = abre == std::string::npos ? std::string::npos : texto.find('+', abre);
+    if (mais == std::string::npos || mais == abre + 1) return texto;
+    int status = 0;
+    char* nome = abi::__cxa_demangle(texto.substr(abre + 1, mais - abre - 1).c_str(), nullptr, nullptr, &status);
+    if (status == 0 && nome) texto.replace(abre + 1, mais - abre - 1, nome);
+    std::free(nome);
+    return texto;
+}
+
+void relatarTravamento(uint64_t paradoNs) {
+    Estado& e = estado();
+    // "número arg1 ... sp pc", ou "running"; só o número interessa
+    std::string syscallAtual = lerTarefa("syscall");
+    syscallAtual = syscallAtual.substr(0, syscallAtual.find(' '));
+    if (syscallAtual.empty()) syscallAtual = "?";
+    Registro::erro(g_log, "UI travada há {} ms (orçamento {} ms): etapa '{}', batimento {}",
+                   paradoNs / 1000000, e.config.orcamentoMs, g_etapa.load(std::memory_order_relaxed),
+                   g_batimentos.load(std::memory_order_relaxed));
+    // wchan e syscall dizem onde uma thread em espera no kernel está parada (ex.: estado D num NFS morto)
+    Registro::erro(g_log, "Thread principal no kernel: estado {}, wchan {}, syscall {}",
+                   estadoKernel(), lerTarefa("wchan"), syscallAtual);
+
+    g_capturada.store(false, std::memory_order_relaxed);
+    if (pthread_kill(e.principal, e.sinal) != 0) return;
+    for (int ms = 0; ms < PRAZO_CAPTURA_MS && !g_capturada.load(std::memory_order_acquire); ++ms)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (!g_capturada.load(std::memory_order_acquire)) {
+        Registro::aviso(g_log, "Pilha não capturada em {} ms (espera não interrompível no kernel?)", PRAZO_CAPTURA_MS);
+        return;
+    }
+    const int profundidade = g_profundidade.load(std::memory_order_relaxed);
+    if (profundidade == 0) {
+        Registro::aviso(g_log, "Pilha não capturada: arquitetura sem suporte.");
+        return;
+    }
+    char** simbolos = backtrace_symbols(g_pilha, profundidade);
+    if (!simbolos) return;
+    for (int i = 0; i < profundidade; ++i)
+        Registro::erro(g_log, "  #{} {}", i, simbolizar(simbolos[i]));
+    std::free(simbolos);
+}
+
+// Troca a imagem do processo por uma nova com os mesmos argumentos. Só retorna
+// se o limite de reinícios já foi atingido.
+void reiniciar(uint64_t paradoNs) {
+    Estado& e = estado();
+    const char* valor = std::getenv(VARIAVEL_REINICIOS);
+    const int reinicios = valor ? std::atoi(valor) : 0;
+    if (reinicios >= MAX_REINICIOS || !e.config.argv) {
+        Registro::erro(g_log, "Reinício não realizado: limite de {} reinícios atingido.", MAX_REINICIOS);
+        return;
+    }
+    Registro::erro(g_log, "Reinício controlado após {} ms travada ({} de {}).", paradoNs / 1000000, reinicios + 1, MAX_REINICIOS);
+
+    // Força zero e jogos terminados antes de trocar a imagem do processo. A
+    // parada dá aos jogos 500 ms entre SIGTERM e SIGKILL, mas o exec a
+    // interromperia antes: os grupos são forçados aqui mesmo, sem esperar.
+    ParadaEmergencia::acionar(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(PRAZO_FORCA_ZERO_MS));
+    const int grupos = Processos::sinalizarTodos(SIGKILL);
+    if (grupos > 0) Registro::aviso(g_log, "{} grupo(s) de jogos forçados (SIGKILL) antes do reinício.", grupos);
+    Registro::encerrar();
+
+    setenv(VARIAVEL_REINICIOS, std::to_string(reinicios + 1).c_str(), 1);
+    // Descritores abertos sem CLOEXEC (USB, GL, bibliotecas) não passam para a nova imagem
+#ifdef SYS_close_range
+    syscall(SYS_close_range, 3u, ~0u, FECHAR_NO_EXEC);
+#endif
+    execv("/proc/self/exe", e.config.argv);
+    std::cerr << "ERRO: Vigia: reinício falhou: " << std::strerror(errno) << std::endl;
+    _exit(EXIT_FAILURE);
+}
+
+void executarThread() {
+    pthread_setname_np(pthread_self(), "vigia");
+    Estado& e = estado();
+    const uint64_t orcamentoNs = (uint64_t)e.config.orcamentoMs * 1000000ull;
+    const uint64_t reinicioNs = (uint64_t)e.config.reinicioMs * 1000000ull;
+    const auto periodo = std::chrono::milliseconds(std::max(10, e.config.orcamentoMs / 4));
+    uint64_t travadoEm = 0;   // Batimento do travamento em curso (já relatado)
+    bool reiniciou = false;   // reiniciar() só retorna se não puder reiniciar
+
+    std::unique_lock<std::mutex> trava(e.mutex);
+    while (!e.cv.wait_for(trava, periodo, [&e] { return e.parar; })) {
+        const uint64_t batimento = g_batimentoNs.load(std::memory_order_acquire);
+        const uint64_t agora = Rastreamento::agoraNs();
+        if (travadoEm != 0 && batimento != travadoEm) {
+            // Novo batimento (ou a UI foi dormir): o travamento acabou
+            const uint64_t fim = batimento != 0 ? batimento : agora;
+            Registro::aviso(g_log, "UI voltou a responder após {} ms.", (fim - travadoEm) / 1000000);
+            Rastreamento::span("UI travada", "vigia", travadoEm, fim);
+            travadoEm = 0;
+        }
+        if (batimento == 0 || agora - batimento < orcamentoNs) continue;
+        if (travadoEm != batimento) {
+            travadoEm = batimento;
+            g_travamentos.fetch_add(1, std::memory_order_relaxed);
+            relatarTravamento(agora - batimento);
+        }
+        if (reinicioNs > 0 && !reiniciou && agora - batimento >= reinicioNs) {
+            reiniciou = true;
+            reiniciar(agora - batimento);
+        }
+    }
+}
+
+} // namespace
+
+bool Vigia::iniciar(const Configuracao& config) {
+    Estado& e = estado();
+    if (config.orcamentoMs <= 0 || e.thread.joinable()) return true;
+    e.config = config;
+    e.principal = pthread_self();
+    e.tidPrincipal = (pid_t)syscall(SYS_gettid);
+    e.sinal = SIGRTMIN + 2; // Os primeiros de tempo real ficam para a glibc/NPTL
+
+    // Limites da pilha para o tratador: fora deles um ponteiro de quadro é lixo
+    pthread_attr_t atributos;
+    void* base = nullptr;
+    size_t tamanho = 0;
+    if (pthread_getattr_np(e.principal, &atributos) != 0) {
+        Registro::erro(g_log, "Vigia da UI indisponível: pilha da thread principal desconhecida.");
+        return false;
+    }
+    pthread_attr_getstack(&atributos, &base, &tamanho);
+    pthread_attr_destroy(&atributos);
+    g_pilhaInicio = (uintptr_t)base;
+    g_pilhaFim = (uintptr_t)base + tamanho;
+
+    struct sigaction acao{};
+    acao.sa_sigaction = tratadorCaptura;
+    acao.sa_flags = SA_SIGINFO | SA_RESTART; // A chamada interrompida (driver, read...) continua depois da captura
+    sigemptyset(&acao.sa_mask);
+    if (sigaction(e.sinal, &acao, nullptr) != 0) {
+        Registro::erro(g_log, "Vigia da UI indisponível: {}", std::strerror(errno));
+        return false;
+    }
+
+    g_batimentoNs.store(Rastreamento::agoraNs(), std::memory_order_release);
+    e.parar = false;
+    e.thread = std::thread(executarThread);
+    static bool registrado = false;
+    if (!registrado) { std::atexit(encerrar); registrado = true; }
+    if (config.reinicioMs > 0)
+        Registro::info(g_log, "Vigia da UI ativa: orçamento {} ms, reinício após {} ms.", config.orcamentoMs, config.reinicioMs);
+    else
+        Registro::info(g_log, "Vigia da UI ativa: orçamento {} ms.", config.orcamentoMs);
+    return true;
+}
+
+void Vigia::encerrar() {
+    Estado& e = estado();
+    if (!e.thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> trava(e.mutex);
+        e.parar = true;
+    }
+    e.cv.notify_one();
+    e.thread.join();
+    g_batimentoNs.store(0, std::memory_order_relaxed);
+}
+
+void Vigia::batimento(const char* etapa) {
+    // Um único escritor: load + store, sem instrução atômica de leitura-escrita
+    g_etapa.store(etapa, std::memory_order_relaxed);
+    g_batimentos.store(g_batimentos.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    g_batimentoNs.store(Rastreamento::agoraNs(), std::memory_order_release);
+}
+
+void Vigia::ocioso() {
+    g_batimentoNs.store(0, std::memory_order_release);
+}
+
+uint64_t Vigia::travamentos() {
+    return g_travamentos.load(std::memory_order_relaxed);
+}
+
+bool lerOpcoesVigia(int argc, char** argv, Vigia::Configuracao& config) {
+    config.argv = argv;
+    for (int i = 1; i < argc; ++i) {
+        int* destino = nullptr;
+        if (std::strcmp(argv[i], "--watchdog-ms") == 0) destino = &config.orcamentoMs;
+        else if (std::strcmp(argv[i], "--watchdog-restart-ms") == 0) destino = &config.reinicioMs;
+        if (!destino) continue;
+        char* fim = nullptr;
+        const long valor = i + 1 < argc ? std::strtol(argv[i + 1], &fim, 10) : -1;
+        if (i + 1 >= argc || *fim != '\0' || valor < 0 || valor > 3600 * 1000) {
+            std::cerr << "Valor inválido para " << argv[i] << " (milissegundos, 0 desliga)" << std::endl;
+            return false;
+        }
+        *destino = (int)valor;
+        ++i;
+    }
+    if (config.reinicioMs > 0 && config.reinicioMs < config.orcamentoMs) {
+        std::cerr << "--watchdog-restart-ms precisa ser maior que --watchdog-ms" << std::endl;
+        return false;
+    }
+    return true;
+}
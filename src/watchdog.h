@@ -0,0 +1,44 @@
+// watchdog.h
+#pragma once
+#include <cstdint>
+
+// Vigia da thread da UI.
+//
+// A thread principal dá um batimento a cada quadro (e a cada etapa da
+// inicialização). Uma thread de fundo confere o último batimento; se ele
+// passar do orçamento, a UI está travada (driver GL bloqueado, sistema de
+// arquivos parado, fonte num ponto de montagem morto...). A vigia então
+// interrompe a thread principal com um sinal cujo tratador só percorre os
+// ponteiros de quadro da pilha, e registra no log a pilha simbolizada com o
+// contexto: etapa, quadro, tempo parado e o estado da thread no kernel (/proc:
+// estado, wchan, syscall). Uma thread em espera não interrompível (estado D) só recebe o
+// sinal quando sair dela; nesse caso o log traz apenas o estado do kernel.
+//
+// Opcionalmente, travada além de um segundo prazo, a vigia faz um reinício
+// controlado: aciona a parada de emergência (força zero, jogos terminados),
+// drena o log e reexecuta o launcher com os mesmos argumentos.
+namespace Vigia {
+    struct Configuracao {
+        int orcamentoMs = 1000;   // 0 = vigia desligada
+        int reinicioMs = 0;       // 0 = só registra; > 0 = reinicia após esse tempo travada
+        char** argv = nullptr;    // Para o reinício
+    };
+
+    // Chamar depois de ParadaEmergencia::instalar e Registro::iniciar, na
+    // thread principal (é ela que passa a ser vigiada).
+    bool iniciar(const Configuracao& config);
+    void encerrar();
+
+    // Thread principal: marca progresso. 'etapa' precisa ter vida estática.
+    // Custa dois stores relaxados.
+    void batimento(const char* etapa = "quadro");
+    // Thread principal: vai dormir de propósito (aguardar o laço de eventos);
+    // a espera não conta como travamento até o próximo batimento.
+    void ocioso();
+
+    uint64_t travamentos();
+}
+
+// Lê --watchdog-ms N (0 desliga) e --watchdog-restart-ms N. Retorna false se
+// um valor for inválido.
+bool lerOpcoesVigia(int argc, char** argv, Vigia::Configuracao& config);